@@ -2,9 +2,17 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
 #include <ctype.h>
 
+static void chip8_dispatch_init(void);
+
 void chip8_init(chip8_t* chip) {
+    // Make sure the opcode dispatch tables are ready before the first instruction executes
+    chip8_dispatch_init();
+
     // Initialize memory to 0
     memset(chip->mem, 0, sizeof(chip->mem));
 
@@ -17,52 +25,218 @@ void chip8_init(chip8_t* chip) {
     // Initialize stack pointer to 0
     chip->sp = 0;
 
-    // Initialize keypad to 0
-    memset(chip->keypad, 0, sizeof(chip->keypad));
+    // Initialize the keypad mask (and its per-batch latch) to no keys down
+    chip->keypad = 0;
+    chip->keypad_latch = 0;
 
-    // Initialize display to 0
+    // Initialize display to 0 (both the byte-per-pixel and the packed buffer), along with the
+    // presented front buffer and its seqlock
     memset(chip->display, 0, sizeof(chip->display));
+    memset(chip->display64, 0, sizeof(chip->display64));
+    memset(chip->display_front, 0, sizeof(chip->display_front));
+    chip->display_seq = 0;
+    chip->display_frame = 0;
+
+    // Mark every row dirty so the renderer draws the first (blank) frame
+    chip->dirty_rows = 0xFFFFFFFF;
+
+    // Reset the cycle counter and the execution trace ring
+    chip->cycles = 0;
+    chip->trace_head = 0;
+
+    // Seed the per-instance RNG with the default seed
+    chip8_seed(chip, 0);
+
+    // No sound is playing, no Fx0A key-wait is pending and no spin loop has been detected on
+    // a freshly reset machine
+    chip->sound_playing = 0;
+    chip->waiting_key = 0;
+    chip->waiting_key_reg = 0;
+    chip->idle = 0;
+
+    // A fresh machine has no latched fault
+    chip->fault = CHIP8_OK;
+    chip->fault_pc = 0;
+    chip->fault_opcode = 0;
+
+    // Start on the default quirks profile; chip8_set_quirks switches it per ROM
+    chip->quirks = CHIP8_QUIRKS_DEFAULT;
+
+    // All memory granules count as written: this instance has not matched any golden image
+    // yet, so its first chip8_reset_from copies the whole 4K
+    chip->mem_dirty = 0xFFFF;
+
+    // Profiling starts disabled with clean counters
+    chip->profiling = 0;
+    chip8_profile_reset(chip);
+
+    // No predecode cache is attached. chip8_init treats the struct as uninitialized memory,
+    // so hosts re-initializing an instance that has a cache attached should flush it instead
+    // (or detach it first) to avoid leaking the allocation.
+    chip->dcache = NULL;
 }
 
-bool chip8_load_rom(chip8_t* chip, const char* filename) {
+void chip8_seed(chip8_t* chip, uint32_t seed) {
+    // xorshift32 must never hold an all-zero state, so map seed 0 to a fixed default
+    chip->rng = (seed != 0) ? seed : 0x2545F491u;
+}
+
+// Reads a whole ROM file into a freshly malloc'd buffer. Returns NULL (after printing an error)
+// if the file cannot be opened or is too large to fit into Chip-8 program memory.
+static uint8_t* chip8_read_rom_file(const char* filename, size_t* out_len) {
     // Open the file using fopen_s if compiled on Windows
 #if defined(_MSC_VER) || defined(__STDC_LIB_EXT1__)
     FILE* fp;
     errno_t err = fopen_s(&fp, filename, "rb");
     if (err != 0) {
         fprintf(stderr, "Failed to open rom file: %s\n", filename);
-        return false;
+        return NULL;
     }
 #else
     FILE* fp = fopen(filename, "rb");
     if (fp == NULL) {
         fprintf(stderr, "Failed to open rom file: %s\n", filename);
-        return false;
+        return NULL;
     }
 #endif
-    
-    if (!fp) {
-        fprintf(stderr, "Failed to open rom file: %s\n", filename);
-        return false;
-    }
 
     fseek(fp, 0L, SEEK_END);
     long rom_size = ftell(fp);
     rewind(fp);
 
-    if (rom_size > CHIP8_MEM_SIZE - CHIP8_PROGRAM_OFFSET) {
+    if (rom_size < 0 || rom_size > CHIP8_MEM_SIZE - CHIP8_PROGRAM_OFFSET) {
         fprintf(stderr, "rom file too large: %s\n", filename);
         fclose(fp);
-        return false;
+        return NULL;
     }
 
-    uint8_t* rom_buffer = &chip->mem[CHIP8_PROGRAM_OFFSET];
-    fread(rom_buffer, rom_size, 1, fp);
+    uint8_t* rom_buffer = malloc((size_t)rom_size);
+    if (rom_buffer == NULL) {
+        fprintf(stderr, "Failed to allocate rom buffer for: %s\n", filename);
+        fclose(fp);
+        return NULL;
+    }
+
+    fread(rom_buffer, (size_t)rom_size, 1, fp);
     fclose(fp);
 
+    *out_len = (size_t)rom_size;
+    return rom_buffer;
+}
+
+// ############################################################################################################
+// ROM cache
+// ############################################################################################################
+
+// Small cache of ROM images so that a .ch8 file is read from disk only once no matter how many
+// emulator instances load it. Entries live until chip8_rom_cache_clear. Not thread-safe: load
+// ROMs (or warm the cache) before fanning out to worker threads.
+#define CHIP8_ROM_CACHE_SIZE 32
+#define CHIP8_ROM_CACHE_PATH_MAX 260
+
+typedef struct {
+    char path[CHIP8_ROM_CACHE_PATH_MAX];
+    uint8_t* data;
+    size_t len;
+} chip8_rom_cache_entry;
+
+static chip8_rom_cache_entry chip8_rom_cache[CHIP8_ROM_CACHE_SIZE];
+static int chip8_rom_cache_count = 0;
+
+const uint8_t* chip8_rom_cache_get(const char* filename, size_t* out_len) {
+    // Already cached?
+    for (int i = 0; i < chip8_rom_cache_count; i++) {
+        if (strcmp(chip8_rom_cache[i].path, filename) == 0) {
+            *out_len = chip8_rom_cache[i].len;
+            return chip8_rom_cache[i].data;
+        }
+    }
+
+    // No room to remember another image (or the path doesn't fit): let the caller fall back
+    // to a one-off read rather than silently evicting a shared buffer somebody may hold
+    if (chip8_rom_cache_count >= CHIP8_ROM_CACHE_SIZE || strlen(filename) >= CHIP8_ROM_CACHE_PATH_MAX) {
+        return NULL;
+    }
+
+    size_t len;
+    uint8_t* data = chip8_read_rom_file(filename, &len);
+    if (data == NULL) {
+        return NULL;
+    }
+
+    chip8_rom_cache_entry* entry = &chip8_rom_cache[chip8_rom_cache_count++];
+#if defined(_MSC_VER) || defined(__STDC_LIB_EXT1__)
+    strcpy_s(entry->path, sizeof(entry->path), filename);
+#else
+    strcpy(entry->path, filename);
+#endif
+    entry->data = data;
+    entry->len = len;
+
+    *out_len = len;
+    return data;
+}
+
+void chip8_rom_cache_clear(void) {
+    for (int i = 0; i < chip8_rom_cache_count; i++) {
+        free(chip8_rom_cache[i].data);
+        chip8_rom_cache[i].data = NULL;
+        chip8_rom_cache[i].path[0] = '\0';
+    }
+    chip8_rom_cache_count = 0;
+}
+
+// Marks the CHIP8_MEM_GRANULE-sized granules covering [addr, addr+len) as written in the
+// mem_dirty mask, so the next chip8_reset_from copies them back from the golden image. Called
+// from the same places that invalidate the predecode cache - a memory write is the same event
+// seen by two different consumers. Addresses past the 4K space (a runaway I register) are
+// simply clamped; the granules that exist are what reset has to repair.
+static void chip8_mem_mark(chip8_t* chip, uint16_t addr, uint16_t len) {
+    if (len == 0) {
+        return;
+    }
+    uint16_t first = addr / CHIP8_MEM_GRANULE;
+    uint16_t last = (uint16_t)((addr + len - 1) / CHIP8_MEM_GRANULE);
+    for (uint16_t g = first; g <= last && g < CHIP8_MEM_SIZE / CHIP8_MEM_GRANULE; g++) {
+        chip->mem_dirty |= (uint16_t)(1u << g);
+    }
+}
+
+bool chip8_load_rom_from_memory(chip8_t* chip, const uint8_t* data, size_t len) {
+    if (len > (size_t)(CHIP8_MEM_SIZE - CHIP8_PROGRAM_OFFSET)) {
+        fprintf(stderr, "rom image too large: %u bytes\n", (unsigned)len);
+        return false;
+    }
+
+    memcpy(&chip->mem[CHIP8_PROGRAM_OFFSET], data, len);
+    chip8_mem_mark(chip, CHIP8_PROGRAM_OFFSET, (uint16_t)len);
+
+    // Everything previously decoded from program memory is stale now, and a fault latched by
+    // the previous program no longer applies
+    chip8_dcache_flush(chip);
+    chip->fault = CHIP8_OK;
     return true;
 }
 
+bool chip8_load_rom(chip8_t* chip, const char* filename) {
+    size_t len;
+
+    // Serve the image from the ROM cache (reading the file only on the first request)
+    const uint8_t* data = chip8_rom_cache_get(filename, &len);
+    if (data != NULL) {
+        return chip8_load_rom_from_memory(chip, data, len);
+    }
+
+    // Cache unavailable (full, path too long, ...): fall back to a one-off read
+    uint8_t* tmp = chip8_read_rom_file(filename, &len);
+    if (tmp == NULL) {
+        return false;
+    }
+    bool ok = chip8_load_rom_from_memory(chip, tmp, len);
+    free(tmp);
+    return ok;
+}
+
 // This is just for testing
 bool chip8_load_program_from_hex_string(chip8_t* chip, const char* hex_program_data) {
     size_t hex_program_size = strlen(hex_program_data);
@@ -96,183 +270,839 @@ bool chip8_load_program_from_hex_string(chip8_t* chip, const char* hex_program_d
         program_buffer[i / 2] = byte_value;
     }
 
+    chip8_mem_mark(chip, CHIP8_PROGRAM_OFFSET, (uint16_t)program_size);
+
+    // Everything previously decoded from program memory is stale now, and a fault latched by
+    // the previous program no longer applies
+    chip8_dcache_flush(chip);
+    chip->fault = CHIP8_OK;
     return true;
 }
 
+void chip8_display_unpack(chip8_t* chip) {
+    for (int row = 0; row < CHIP8_DISPLAY_HEIGHT; row++) {
+        uint64_t bits = chip->display64[row];
+        uint8_t* out = &chip->display[row * CHIP8_DISPLAY_WIDTH];
+        for (int col = 0; col < CHIP8_DISPLAY_WIDTH; col++) {
+            out[col] = (bits >> (63 - col)) & 1;
+        }
+    }
+}
+
+// Atomic bump/load of the display seqlock counter. The interlocked forms are full barriers on
+// both toolchains, which is what orders the counter updates against the frame copy between
+// them (the same scheme chip8_shm uses for its cross-process export).
+#if defined(_MSC_VER)
+#define chip8_display_seq_bump(p) _InterlockedIncrement((volatile long*)(p))
+#define chip8_display_seq_load(p) ((uint32_t)_InterlockedOr((volatile long*)(p), 0))
+#else
+#define chip8_display_seq_bump(p) __sync_add_and_fetch((p), 1u)
+#define chip8_display_seq_load(p) __sync_fetch_and_or((uint32_t*)(p), 0u)
+#endif
+
+void chip8_present(chip8_t* chip) {
+    // Seqlock write: odd while the front buffer is inconsistent, even when it is safe to read
+    chip8_display_seq_bump(&chip->display_seq);
+
+    if (chip->colorMode) {
+        memcpy(chip->display_front, chip->display, sizeof(chip->display_front));
+    }
+    else {
+        // Expand the packed monochrome rows straight into the front buffer; the working
+        // byte-per-pixel buffer is not touched, so presenting never perturbs the interpreter
+        for (int row = 0; row < CHIP8_DISPLAY_HEIGHT; row++) {
+            uint64_t bits = chip->display64[row];
+            uint8_t* out = &chip->display_front[row * CHIP8_DISPLAY_WIDTH];
+            for (int col = 0; col < CHIP8_DISPLAY_WIDTH; col++) {
+                out[col] = (bits >> (63 - col)) & 1;
+            }
+        }
+    }
+    chip->display_frame++;
+
+    chip8_display_seq_bump(&chip->display_seq);
+}
+
+bool chip8_display_read(const chip8_t* chip, uint8_t* out, uint32_t* frame) {
+    for (;;) {
+        uint32_t seq = chip8_display_seq_load(&chip->display_seq);
+        if (seq & 1) {
+            // A present is in flight; it finishes within a 2 KB copy, so just spin
+            continue;
+        }
+
+        uint32_t published = chip->display_frame;
+        if (published == 0) {
+            return false;
+        }
+        memcpy(out, chip->display_front, CHIP8_DISPLAY_BUFFER_SIZE);
+
+        if (chip8_display_seq_load(&chip->display_seq) == seq) {
+            // No present raced our copy: the frame is consistent
+            if (frame != NULL) {
+                *frame = published;
+            }
+            return true;
+        }
+    }
+}
+
+void chip8_snapshot(const chip8_t* chip, void* buf) {
+    chip8_snapshot_header header;
+    header.magic = CHIP8_SNAPSHOT_MAGIC;
+    header.version = CHIP8_SNAPSHOT_VERSION;
+    header.size = (uint32_t)sizeof(chip8_t);
+
+    memcpy(buf, &header, sizeof(header));
+    memcpy((uint8_t*)buf + sizeof(header), chip, sizeof(chip8_t));
+}
+
+bool chip8_restore(chip8_t* chip, const void* buf) {
+    chip8_snapshot_header header;
+    memcpy(&header, buf, sizeof(header));
+
+    if (header.magic != CHIP8_SNAPSHOT_MAGIC) {
+        fprintf(stderr, "Snapshot rejected: bad magic 0x%08X\n", header.magic);
+        return false;
+    }
+    if (header.version != CHIP8_SNAPSHOT_VERSION || header.size != (uint32_t)sizeof(chip8_t)) {
+        fprintf(stderr, "Snapshot rejected: version %u/size %u does not match this build (version %u/size %u)\n",
+            header.version, header.size, CHIP8_SNAPSHOT_VERSION, (uint32_t)sizeof(chip8_t));
+        return false;
+    }
+
+    // The dcache pointer is host-local, not machine state: keep this instance's cache (the
+    // snapshotted pointer may come from another process) and flush it, since the restored
+    // program memory no longer matches the decoded records.
+    struct chip8_dcache* dcache = chip->dcache;
+    memcpy(chip, (const uint8_t*)buf + sizeof(header), sizeof(chip8_t));
+    chip->dcache = dcache;
+    chip8_dcache_flush(chip);
+    return true;
+}
+
+void chip8_reset_from(chip8_t* chip, const chip8_t* golden) {
+    // Copy back only the memory granules this instance wrote since it last matched a golden
+    // image. Everything it did not write - the font set, the ROM - is bit-identical to the
+    // golden copy already and never moves, which is the whole point: resetting 200 instances
+    // must not stream 200 identical ROM images through the cache.
+    uint16_t dirty = chip->mem_dirty;
+    for (uint16_t g = 0; dirty != 0; g++, dirty >>= 1) {
+        if (dirty & 1) {
+            memcpy(&chip->mem[(size_t)g * CHIP8_MEM_GRANULE],
+                &golden->mem[(size_t)g * CHIP8_MEM_GRANULE], CHIP8_MEM_GRANULE);
+        }
+    }
+
+    // The rest of the struct (registers through the display buffers) is small next to the 4K
+    // and nearly all of it diverges every run, so it goes in one block copy: everything
+    // between the end of mem and the host-local dcache pointer, which stays this instance's
+    // own exactly as in chip8_restore.
+    memcpy(&chip->V[0], &golden->V[0], offsetof(chip8_t, dcache) - offsetof(chip8_t, V));
+
+    // This instance is now an exact copy of the golden image again
+    chip->mem_dirty = 0;
+    chip8_dcache_flush(chip);
+}
+
+uint32_t chip8_take_dirty_rows(chip8_t* chip) {
+    uint32_t rows = chip->dirty_rows;
+    chip->dirty_rows = 0;
+    return rows;
+}
+
+// One atomic read-modify-write on the 16-bit keypad mask, so chip8_set_key can run on an
+// input thread while the emulation thread executes a batch (which reads its own latched copy)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define chip8_keypad_or(p, bit)   _InterlockedOr16((volatile short*)(p), (short)(bit))
+#define chip8_keypad_and(p, mask) _InterlockedAnd16((volatile short*)(p), (short)(mask))
+#else
+#define chip8_keypad_or(p, bit)   __sync_fetch_and_or((p), (uint16_t)(bit))
+#define chip8_keypad_and(p, mask) __sync_fetch_and_and((p), (uint16_t)(mask))
+#endif
+
+// Index of the lowest set bit of a nonzero 16-bit mask (used by Fx0A to pick the same key an
+// ascending scan of the old keypad array would have)
+#if defined(_MSC_VER)
+static int chip8_ctz16(uint16_t v) {
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return (int)index;
+}
+#else
+#define chip8_ctz16(v) __builtin_ctz(v)
+#endif
+
 void chip8_set_key(chip8_t* chip, chip8_key key, uint8_t state) {
     if (key >= CHIP8_KEY_0 && key <= CHIP8_KEY_F) {
-        chip->keypad[key] = state;
+        uint16_t bit = (uint16_t)(1u << key);
+        if (state) {
+            chip8_keypad_or(&chip->keypad, bit);
+        }
+        else {
+            chip8_keypad_and(&chip->keypad, (uint16_t)~bit);
+        }
+
+        // A key event may change the outcome of a parked spin loop (Ex9E/ExA1 polls inside it)
+        chip->idle = 0;
+
+        // Wake a core that is halted on Fx0A: deliver the key and complete the instruction
+        // here, so chip8_step/chip8_run never had to spin on it (event-driven instead of
+        // polled - a waiting instance costs zero interpreter cycles).
+        if (state && chip->waiting_key) {
+            chip->V[chip->waiting_key_reg] = (uint8_t)key;
+            chip->waiting_key = 0;
+            chip->pc += 2;
+        }
     }
 }
 
 
-void chip8_step(chip8_t* chip) {
-    if (chip->pc < CHIP8_PROGRAM_OFFSET || chip->pc >= CHIP8_MEM_SIZE) {
-        fprintf(stderr, "Program counter out of bounds: 0x%04X\n", chip->pc);
+// ############################################################################################################
+// Opcode dispatch tables
+// ############################################################################################################
+
+// Operand extraction helpers shared by the dispatch wrappers below
+#define CHIP8_OP_X(op)   ((uint8_t)(((op) & 0x0F00) >> 8))
+#define CHIP8_OP_Y(op)   ((uint8_t)(((op) & 0x00F0) >> 4))
+#define CHIP8_OP_N(op)   ((uint8_t)((op) & 0x000F))
+#define CHIP8_OP_KK(op)  ((uint8_t)((op) & 0x00FF))
+#define CHIP8_OP_NNN(op) ((uint16_t)((op) & 0x0FFF))
+
+// Thin wrappers that adapt the chip8_CLS/chip8_LD_Vx_byte-style handlers to the uniform
+// (chip, opcode) signature the dispatch tables need. The operand extraction that used to live
+// in the big decode switch happens here instead.
+static void chip8_op_unknown(chip8_t* chip, uint16_t opcode) {
+    // No stderr here: a faulting ROM re-fetches the bad opcode at full interpreter speed, and
+    // the stdio formatting would dominate the run. Latch the fault instead; chip8_step and
+    // chip8_run stop on it and return the code, and whether anything gets printed is up to
+    // the host.
+    chip->fault = CHIP8_ERR_BAD_OPCODE;
+    chip->fault_pc = chip->pc;
+    chip->fault_opcode = opcode;
+}
+
+static void chip8_op_CLS(chip8_t* chip, uint16_t opcode) { (void)opcode; chip8_CLS(chip); }
+static void chip8_op_RET(chip8_t* chip, uint16_t opcode) { (void)opcode; chip8_RET(chip); }
+static void chip8_op_JP_addr(chip8_t* chip, uint16_t opcode) { chip8_JP_addr(chip, CHIP8_OP_NNN(opcode)); }
+static void chip8_op_CALL_addr(chip8_t* chip, uint16_t opcode) { chip8_CALL_addr(chip, CHIP8_OP_NNN(opcode)); }
+static void chip8_op_SE_Vx_byte(chip8_t* chip, uint16_t opcode) { chip8_SE_Vx_byte(chip, CHIP8_OP_X(opcode), CHIP8_OP_KK(opcode)); }
+static void chip8_op_SNE_Vx_byte(chip8_t* chip, uint16_t opcode) { chip8_SNE_Vx_byte(chip, CHIP8_OP_X(opcode), CHIP8_OP_KK(opcode)); }
+static void chip8_op_SE_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_SE_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_LD_Vx_byte(chip8_t* chip, uint16_t opcode) { chip8_LD_Vx_byte(chip, CHIP8_OP_X(opcode), CHIP8_OP_KK(opcode)); }
+static void chip8_op_ADD_Vx_byte(chip8_t* chip, uint16_t opcode) { chip8_ADD_Vx_byte(chip, CHIP8_OP_X(opcode), CHIP8_OP_KK(opcode)); }
+static void chip8_op_LD_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_LD_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_OR_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_OR_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_AND_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_AND_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_XOR_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_XOR_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_ADD_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_ADD_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_SUB_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_SUB_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_SHR_Vx(chip8_t* chip, uint16_t opcode) { chip8_SHR_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_SUBN_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_SUBN_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_SHL_Vx(chip8_t* chip, uint16_t opcode) { chip8_SHL_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_SNE_Vx_Vy(chip8_t* chip, uint16_t opcode) { chip8_SNE_Vx_Vy(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode)); }
+static void chip8_op_LD_I_addr(chip8_t* chip, uint16_t opcode) { chip8_LD_I_addr(chip, CHIP8_OP_NNN(opcode)); }
+static void chip8_op_JP_V0_addr(chip8_t* chip, uint16_t opcode) { chip8_JP_V0_addr(chip, CHIP8_OP_NNN(opcode)); }
+static void chip8_op_RND_Vx_byte(chip8_t* chip, uint16_t opcode) { chip8_RND_Vx_byte(chip, CHIP8_OP_X(opcode), CHIP8_OP_KK(opcode)); }
+static void chip8_op_DRW_Vx_Vy_nibble(chip8_t* chip, uint16_t opcode) { chip8_DRW_Vx_Vy_nibble(chip, CHIP8_OP_X(opcode), CHIP8_OP_Y(opcode), CHIP8_OP_N(opcode)); }
+static void chip8_op_SKP_Vx(chip8_t* chip, uint16_t opcode) { chip8_SKP_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_SKNP_Vx(chip8_t* chip, uint16_t opcode) { chip8_SKNP_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_Vx_DT(chip8_t* chip, uint16_t opcode) { chip8_LD_Vx_DT(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_Vx_K(chip8_t* chip, uint16_t opcode) { chip8_LD_Vx_K(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_DT_Vx(chip8_t* chip, uint16_t opcode) { chip8_LD_DT_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_ST_Vx(chip8_t* chip, uint16_t opcode) { chip8_LD_ST_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_ADD_I_Vx(chip8_t* chip, uint16_t opcode) { chip8_ADD_I_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_SETCLR_Vx(chip8_t* chip, uint16_t opcode) { chip8_SETCLR_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_F_Vx(chip8_t* chip, uint16_t opcode) { chip8_LD_F_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_B_Vx(chip8_t* chip, uint16_t opcode) { chip8_LD_B_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_I_Vx(chip8_t* chip, uint16_t opcode) { chip8_LD_I_Vx(chip, CHIP8_OP_X(opcode)); }
+static void chip8_op_LD_Vx_I(chip8_t* chip, uint16_t opcode) { chip8_LD_Vx_I(chip, CHIP8_OP_X(opcode)); }
+
+// Defined with the predecode cache below; the Fx55 variant needs it for self-modifying code
+static void chip8_dcache_invalidate(chip8_t* chip, uint16_t addr, uint16_t len);
+
+// Quirk variant handlers. These are the handful of instructions whose behavior differs
+// between interpreter lineages (see chip8_quirks); each variant is a complete handler
+// installed in that profile's copy of the dispatch tables, so no handler ever checks the
+// active profile at execution time.
+
+// 8xy6 COSMAC variant: shift Vy right into Vx (the default handler shifts Vx in place)
+static void chip8_op_SHR_Vx_Vy(chip8_t* chip, uint16_t opcode) {
+    uint8_t x = CHIP8_OP_X(opcode);
+    uint8_t y = CHIP8_OP_Y(opcode);
+    chip->V[0xF] = chip->V[y] & 0x1;
+    chip->V[x] = chip->V[y] >> 1;
+    chip->pc += 2;
+}
+
+// 8xyE COSMAC variant: shift Vy left into Vx
+static void chip8_op_SHL_Vx_Vy(chip8_t* chip, uint16_t opcode) {
+    uint8_t x = CHIP8_OP_X(opcode);
+    uint8_t y = CHIP8_OP_Y(opcode);
+    chip->V[0xF] = chip->V[y] >> 7;
+    chip->V[x] = (uint8_t)(chip->V[y] << 1);
+    chip->pc += 2;
+}
+
+// Fx55 SUPER-CHIP variant: store V0..Vx without incrementing I afterwards. Still a memory
+// write, so it invalidates the predecode cache exactly like the default handler.
+static void chip8_op_LD_I_Vx_noinc(chip8_t* chip, uint16_t opcode) {
+    uint8_t x = CHIP8_OP_X(opcode);
+    for (uint8_t i = 0; i <= x; i++) {
+        chip->mem[chip->I + i] = chip->V[i];
+    }
+    chip8_dcache_invalidate(chip, chip->I, (uint16_t)(x + 1));
+    chip8_mem_mark(chip, chip->I, (uint16_t)(x + 1));
+    chip->pc += 2;
+}
+
+// Fx65 SUPER-CHIP variant: read V0..Vx without incrementing I afterwards
+static void chip8_op_LD_Vx_I_noinc(chip8_t* chip, uint16_t opcode) {
+    uint8_t x = CHIP8_OP_X(opcode);
+    for (uint8_t i = 0; i <= x; i++) {
+        chip->V[i] = chip->mem[chip->I + i];
+    }
+    chip->pc += 2;
+}
+
+// Second-level tables for the opcode families that need a second decode step. Every slot is
+// pre-filled (with chip8_op_unknown where no instruction exists), so dispatch never has to
+// NULL-check: decode is one table load and one indirect call per level. The two families
+// containing quirk-dependent instructions keep one complete table copy per quirks profile,
+// indexed by chip->quirks - selecting a profile swaps which copy an instance reads, it never
+// adds a branch.
+static chip8_opcode_fn chip8_table_0[256];                      // 00xx, indexed by the low byte
+static chip8_opcode_fn chip8_table_8[CHIP8_QUIRKS_COUNT][16];   // 8xyN, indexed by profile and the low nibble
+static chip8_opcode_fn chip8_table_E[256];                      // ExXX, indexed by the low byte
+static chip8_opcode_fn chip8_table_F[CHIP8_QUIRKS_COUNT][256];  // FxXX, indexed by profile and the low byte
+
+static void chip8_op_family_0(chip8_t* chip, uint16_t opcode) { chip8_table_0[opcode & 0x00FF](chip, opcode); }
+static void chip8_op_family_8(chip8_t* chip, uint16_t opcode) { chip8_table_8[chip->quirks][opcode & 0x000F](chip, opcode); }
+static void chip8_op_family_E(chip8_t* chip, uint16_t opcode) { chip8_table_E[opcode & 0x00FF](chip, opcode); }
+static void chip8_op_family_F(chip8_t* chip, uint16_t opcode) { chip8_table_F[chip->quirks][opcode & 0x00FF](chip, opcode); }
+
+// Top-level table indexed by the high nibble of the opcode
+static chip8_opcode_fn chip8_table_main[16];
+
+// One-time state of the dispatch tables: 0 = untouched, 1 = being filled, 2 = published.
+// Interlocked (not a plain bool) because chip8_init runs concurrently on pool worker threads.
+#if defined(_MSC_VER)
+static volatile long chip8_dispatch_state = 0;
+#else
+static volatile int chip8_dispatch_state = 0;
+#endif
+
+// Fills the dispatch tables. Called from chip8_init, so hosts that only ever use
+// chip8_step/chip8_run never have to know the tables exist. The first caller claims the fill
+// with an interlocked compare-exchange and publishes the ready state with a full barrier only
+// *after* every slot is written; any concurrent caller spins on the flag for the few
+// microseconds the fill takes. Publishing the flag before the tables are complete is exactly
+// the race that let a second pool worker dispatch through a half-filled table.
+static void chip8_dispatch_init(void) {
+#if defined(_MSC_VER)
+    if (_InterlockedCompareExchange(&chip8_dispatch_state, 1, 0) != 0) {
+        while (_InterlockedCompareExchange(&chip8_dispatch_state, 2, 2) != 2) {
+            // another thread is filling the tables right now
+        }
+        return;
+    }
+#else
+    if (__sync_val_compare_and_swap(&chip8_dispatch_state, 0, 1) != 0) {
+        while (__sync_val_compare_and_swap(&chip8_dispatch_state, 2, 2) != 2) {
+            // another thread is filling the tables right now
+        }
         return;
     }
+#endif
 
-    // Fetch the current instruction from memory
-    uint16_t opcode = (chip->mem[chip->pc] << 8) | chip->mem[chip->pc + 1];
+    for (int i = 0; i < 256; i++) {
+        chip8_table_0[i] = chip8_op_unknown;
+        chip8_table_E[i] = chip8_op_unknown;
+        chip8_table_F[CHIP8_QUIRKS_DEFAULT][i] = chip8_op_unknown;
+    }
+    for (int i = 0; i < 16; i++) {
+        chip8_table_8[CHIP8_QUIRKS_DEFAULT][i] = chip8_op_unknown;
+        chip8_table_main[i] = chip8_op_unknown;
+    }
 
-#ifdef DEBUG
-    // Print the fetched opcode in debug mode
-    fprintf(stderr, "Fetched opcode: 0x%X\n", opcode);
+    chip8_table_main[0x0] = chip8_op_family_0;
+    chip8_table_main[0x1] = chip8_op_JP_addr;
+    chip8_table_main[0x2] = chip8_op_CALL_addr;
+    chip8_table_main[0x3] = chip8_op_SE_Vx_byte;
+    chip8_table_main[0x4] = chip8_op_SNE_Vx_byte;
+    chip8_table_main[0x5] = chip8_op_SE_Vx_Vy;
+    chip8_table_main[0x6] = chip8_op_LD_Vx_byte;
+    chip8_table_main[0x7] = chip8_op_ADD_Vx_byte;
+    chip8_table_main[0x8] = chip8_op_family_8;
+    chip8_table_main[0x9] = chip8_op_SNE_Vx_Vy;
+    chip8_table_main[0xA] = chip8_op_LD_I_addr;
+    chip8_table_main[0xB] = chip8_op_JP_V0_addr;
+    chip8_table_main[0xC] = chip8_op_RND_Vx_byte;
+    chip8_table_main[0xD] = chip8_op_DRW_Vx_Vy_nibble;
+    chip8_table_main[0xE] = chip8_op_family_E;
+    chip8_table_main[0xF] = chip8_op_family_F;
+
+    chip8_table_0[0xE0] = chip8_op_CLS;
+    chip8_table_0[0xEE] = chip8_op_RET;
+
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x0] = chip8_op_LD_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x1] = chip8_op_OR_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x2] = chip8_op_AND_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x3] = chip8_op_XOR_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x4] = chip8_op_ADD_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x5] = chip8_op_SUB_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x6] = chip8_op_SHR_Vx;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0x7] = chip8_op_SUBN_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_DEFAULT][0xE] = chip8_op_SHL_Vx;
+
+    chip8_table_E[0x9E] = chip8_op_SKP_Vx;
+    chip8_table_E[0xA1] = chip8_op_SKNP_Vx;
+
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x07] = chip8_op_LD_Vx_DT;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x0A] = chip8_op_LD_Vx_K;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x15] = chip8_op_LD_DT_Vx;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x18] = chip8_op_LD_ST_Vx;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x1E] = chip8_op_ADD_I_Vx;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x1F] = chip8_op_SETCLR_Vx; // NEW: Fx1F - Set the color mode based on the value of Vx
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x29] = chip8_op_LD_F_Vx;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x33] = chip8_op_LD_B_Vx;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x55] = chip8_op_LD_I_Vx;
+    chip8_table_F[CHIP8_QUIRKS_DEFAULT][0x65] = chip8_op_LD_Vx_I;
+
+    // The other profiles start as exact copies of the default tables with only their variant
+    // slots patched, so every non-quirky instruction shares one handler across all profiles
+    for (int q = 1; q < CHIP8_QUIRKS_COUNT; q++) {
+        memcpy(chip8_table_8[q], chip8_table_8[CHIP8_QUIRKS_DEFAULT], sizeof(chip8_table_8[q]));
+        memcpy(chip8_table_F[q], chip8_table_F[CHIP8_QUIRKS_DEFAULT], sizeof(chip8_table_F[q]));
+    }
+    chip8_table_8[CHIP8_QUIRKS_COSMAC][0x6] = chip8_op_SHR_Vx_Vy;
+    chip8_table_8[CHIP8_QUIRKS_COSMAC][0xE] = chip8_op_SHL_Vx_Vy;
+    chip8_table_F[CHIP8_QUIRKS_SCHIP][0x55] = chip8_op_LD_I_Vx_noinc;
+    chip8_table_F[CHIP8_QUIRKS_SCHIP][0x65] = chip8_op_LD_Vx_I_noinc;
+
+    // Every slot is written: publish with a full barrier so a waiting thread that sees the
+    // ready state also sees the completed tables
+#if defined(_MSC_VER)
+    _InterlockedExchange(&chip8_dispatch_state, 2);
+#else
+    __sync_val_compare_and_swap(&chip8_dispatch_state, 1, 2);
 #endif
+}
 
-    // Decode and execute the instruction
-    switch (opcode & 0xF000) {
-    case 0x0000:
-        switch (opcode & 0x00FF) {
-        case 0x00E0:
-            chip8_CLS(chip);
-            break;
-        case 0x00EE:
-            chip8_RET(chip);
-            break;
-        default:
-            fprintf(stderr, "Unknown instruction: 0x%X\n", opcode);
-            break;
+void chip8_set_quirks(chip8_t* chip, chip8_quirks quirks) {
+    if (quirks >= CHIP8_QUIRKS_COUNT) {
+        quirks = CHIP8_QUIRKS_DEFAULT;
+    }
+    if (chip->quirks != (uint8_t)quirks) {
+        chip->quirks = (uint8_t)quirks;
+        // Cached records hold handlers resolved through the old profile's tables
+        chip8_dcache_flush(chip);
+    }
+}
+
+
+// ############################################################################################################
+// Predecode cache
+// ############################################################################################################
+
+// Longest translated block, in instructions. Invalidation must clear the block length of
+// every head whose block could span a written byte, so keeping this small bounds that walk.
+#define CHIP8_DCACHE_BLOCK_MAX 32
+
+// One decoded record per even program address. `fn` is the fully resolved handler (second-level
+// tables already walked), so executing a cached instruction is one indexed load plus one
+// indirect call; fn == NULL marks the slot as not yet decoded.
+//
+// `block_len` turns the cache into a block translator: on a block head it is the number of
+// consecutive records (this one included) that can execute back-to-back without re-checking
+// the PC between them - a straight line of pc += 2 instructions up to and including the first
+// control-transfer opcode. 0 means the block starting here has not been translated yet.
+typedef struct {
+    chip8_opcode_fn fn;
+    uint16_t opcode;
+    uint16_t block_len;
+} chip8_dcache_entry;
+
+struct chip8_dcache {
+    chip8_dcache_entry entries[CHIP8_MEM_SIZE / 2];
+};
+
+// Resolves an opcode to its final handler, walking the second-level table for the families
+// that need one (under the instance's quirks profile, which is why records cached under one
+// profile must be flushed when it changes). This is the slow path the cache amortizes: it
+// runs once per program address (until invalidated) instead of once per executed instruction.
+static chip8_opcode_fn chip8_decode(const chip8_t* chip, uint16_t opcode) {
+    switch (opcode >> 12) {
+    case 0x0: return chip8_table_0[opcode & 0x00FF];
+    case 0x8: return chip8_table_8[chip->quirks][opcode & 0x000F];
+    case 0xE: return chip8_table_E[opcode & 0x00FF];
+    case 0xF: return chip8_table_F[chip->quirks][opcode & 0x00FF];
+    default:  return chip8_table_main[opcode >> 12];
+    }
+}
+
+void chip8_dcache_enable(chip8_t* chip, bool enable) {
+    if (enable) {
+        if (chip->dcache == NULL) {
+            // calloc leaves every fn NULL, i.e. every slot starts out not-yet-decoded
+            chip->dcache = (struct chip8_dcache*)calloc(1, sizeof(struct chip8_dcache));
         }
-        break;
-    case 0x1000:
-        chip8_JP_addr(chip, opcode & 0x0FFF);
-        break;
-    case 0x2000:
-        chip8_CALL_addr(chip, opcode & 0x0FFF);
-        break;
-    case 0x3000:
-        chip8_SE_Vx_byte(chip, (opcode & 0x0F00) >> 8, opcode & 0x00FF);
-        break;
-    case 0x4000:
-        chip8_SNE_Vx_byte(chip, (opcode & 0x0F00) >> 8, opcode & 0x00FF);
-        break;
-    case 0x5000:
-        chip8_SE_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-        break;
-    case 0x6000:
-        chip8_LD_Vx_byte(chip, (opcode & 0x0F00) >> 8, opcode & 0x00FF);
-        break;
-    case 0x7000:
-        chip8_ADD_Vx_byte(chip, (opcode & 0x0F00) >> 8, opcode & 0x00FF);
-        break;
-    case 0x8000:
-        switch (opcode & 0x000F) {
-        case 0x0000:
-            chip8_LD_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x0001:
-            chip8_OR_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x0002:
-            chip8_AND_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x0003:
-            chip8_XOR_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x0004:
-            chip8_ADD_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x0005:
-            chip8_SUB_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x0006:
-            chip8_SHR_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0007:
-            chip8_SUBN_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-            break;
-        case 0x000E:
-            chip8_SHL_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        default:
-            fprintf(stderr, "Unknown instruction: 0x%X\n", opcode);
-            break;
+    }
+    else {
+        free(chip->dcache);
+        chip->dcache = NULL;
+    }
+}
+
+void chip8_dcache_flush(chip8_t* chip) {
+    if (chip->dcache != NULL) {
+        memset(chip->dcache->entries, 0, sizeof(chip->dcache->entries));
+    }
+}
+
+// Discards the decoded records covering the `len` bytes written at `addr`. A write to byte
+// `a` can only change the instruction starting at `a & ~1` (instructions are two bytes and
+// only even addresses are cached), so one record per written byte is enough. Translated
+// blocks reaching into the written range from up to CHIP8_DCACHE_BLOCK_MAX - 1 records before
+// it have their block length cleared too, so they get retranslated before the next execution.
+static void chip8_dcache_invalidate(chip8_t* chip, uint16_t addr, uint16_t len) {
+    if (chip->dcache == NULL || len == 0) {
+        return;
+    }
+    uint16_t last = addr + len - 1;
+    if (last >= CHIP8_MEM_SIZE) {
+        last = CHIP8_MEM_SIZE - 1;
+    }
+    for (uint16_t a = addr; a <= last; a++) {
+        chip->dcache->entries[a >> 1].fn = NULL;
+        chip->dcache->entries[a >> 1].block_len = 0;
+    }
+
+    uint16_t first = addr >> 1;
+    uint16_t span = CHIP8_DCACHE_BLOCK_MAX - 1;
+    uint16_t begin = (first > span) ? (uint16_t)(first - span) : 0;
+    for (uint16_t e = begin; e < first; e++) {
+        chip->dcache->entries[e].block_len = 0;
+    }
+}
+
+// True for every opcode that may do something other than fall through to pc + 2: jumps, calls,
+// returns, skips, the Fx0A key-wait, and the self-modifying stores Fx55/Fx33 (which could
+// overwrite later instructions of their own block). These end a translated block; everything
+// else (loads, ALU, Annn, Cxkk, Dxyn) is straight-line code.
+static bool chip8_op_is_block_end(uint16_t opcode) {
+    switch (opcode >> 12) {
+    case 0x0: case 0x1: case 0x2: case 0x3: case 0x4:
+    case 0x5: case 0x9: case 0xB: case 0xE:
+        return true;
+    case 0xF: {
+        uint8_t kk = (uint8_t)(opcode & 0x00FF);
+        return kk == 0x0A || kk == 0x33 || kk == 0x55;
+    }
+    default:
+        return false;
+    }
+}
+
+// Translates the basic block starting at even address `pc`: decodes consecutive records up to
+// and including the first control-transfer opcode (bounded by CHIP8_DCACHE_BLOCK_MAX and the
+// end of memory) and stores the block length on the head record.
+static void chip8_dcache_translate(chip8_t* chip, uint16_t pc) {
+    chip8_dcache_entry* entries = chip->dcache->entries;
+    uint16_t len = 0;
+
+    while (len < CHIP8_DCACHE_BLOCK_MAX && pc + 2 * len + 1 < CHIP8_MEM_SIZE) {
+        chip8_dcache_entry* entry = &entries[(pc >> 1) + len];
+        if (entry->fn == NULL) {
+            uint16_t addr = (uint16_t)(pc + 2 * len);
+            entry->opcode = (chip->mem[addr] << 8) | chip->mem[addr + 1];
+            entry->fn = chip8_decode(chip, entry->opcode);
         }
-        break;
-    case 0x9000:
-        chip8_SNE_Vx_Vy(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4);
-        break;
-    case 0xA000:
-        chip8_LD_I_addr(chip, opcode & 0x0FFF);
-        break;
-    case 0xB000:
-        chip8_JP_V0_addr(chip, opcode & 0x0FFF);
-        break;
-    case 0xC000:
-        chip8_RND_Vx_byte(chip, (opcode & 0x0F00) >> 8, opcode & 0x00FF);
-        break;
-    case 0xD000:
-        chip8_DRW_Vx_Vy_nibble(chip, (opcode & 0x0F00) >> 8, (opcode & 0x00F0) >> 4, opcode & 0x000F);
-        break;
-    case 0xE000:
-        switch (opcode & 0x00FF) {
-        case 0x009E:
-            chip8_SKP_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x00A1:
-            chip8_SKNP_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        default:
-            fprintf(stderr, "Unknown instruction: 0x%X\n", opcode);
+        len++;
+        // Unknown opcodes leave the PC alone (the core spins on them), so they terminate a
+        // block just like a control transfer does
+        if (entry->fn == chip8_op_unknown || chip8_op_is_block_end(entry->opcode)) {
             break;
         }
-        break;
-    case 0xF000:
-        switch (opcode & 0x00FF) {
-        case 0x0007:
-            chip8_LD_Vx_DT(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x000A:
-            chip8_LD_Vx_K(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0015:
-            chip8_LD_DT_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0018:
-            chip8_LD_ST_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x001E:
-            chip8_ADD_I_Vx(chip, (opcode & 0x0F00) >> 8);
-        case 0x001F: // NEW: Fx1F - Set the color mode based on the value of Vx (0 = off, 1 = on)
-            chip8_SETCLR_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0029:
-            chip8_LD_F_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0033:
-            chip8_LD_B_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0055:
-            chip8_LD_I_Vx(chip, (opcode & 0x0F00) >> 8);
-            break;
-        case 0x0065:
-            chip8_LD_Vx_I(chip, (opcode & 0x0F00) >> 8);
-            break;
-        default:
-            fprintf(stderr, "Unknown instruction: 0x%X\n", opcode);
-            break;
+    }
+
+    entries[pc >> 1].block_len = len;
+}
+
+
+// ############################################################################################################
+// Instruction profiler
+// ############################################################################################################
+
+// Cheapest high-resolution tick source available: the CPU timestamp counter on x86, clock()
+// elsewhere. Only relative comparisons between families matter, so the unit is unimportant.
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+static uint64_t chip8_prof_now(void) {
+    return __rdtsc();
+}
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+static uint64_t chip8_prof_now(void) {
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+#else
+#include <time.h>
+static uint64_t chip8_prof_now(void) {
+    return (uint64_t)clock();
+}
+#endif
+
+// Human-readable names for the 16 opcode families, for the profile report
+static const char* chip8_family_names[16] = {
+    "0nnn SYS/CLS/RET", "1nnn JP",   "2nnn CALL",   "3xkk SE",
+    "4xkk SNE",         "5xy0 SE",   "6xkk LD",     "7xkk ADD",
+    "8xyN ALU",         "9xy0 SNE",  "Annn LD I",   "Bnnn JP V0",
+    "Cxkk RND",         "Dxyn DRW",  "Ex9E/A1 SKP", "FxXX misc"
+};
+
+void chip8_profile_enable(chip8_t* chip, bool enable) {
+    chip->profiling = enable ? 1 : 0;
+}
+
+void chip8_profile_reset(chip8_t* chip) {
+    memset(chip->prof_count, 0, sizeof(chip->prof_count));
+    memset(chip->prof_ticks, 0, sizeof(chip->prof_ticks));
+}
+
+void chip8_profile_report(const chip8_t* chip, FILE* out) {
+    uint64_t total_count = 0;
+    uint64_t total_ticks = 0;
+    for (int i = 0; i < 16; i++) {
+        total_count += chip->prof_count[i];
+        total_ticks += chip->prof_ticks[i];
+    }
+
+    fprintf(out, "opcode family      executions    ticks total   ticks/instr   %% of time\n");
+    for (int i = 0; i < 16; i++) {
+        if (chip->prof_count[i] == 0) {
+            continue;
         }
-        break;
-    default:
-        fprintf(stderr, "Unknown instruction: 0x%X\n", opcode);
-        break;
+        fprintf(out, "%-16s %12llu %14llu %13.1f %10.1f%%\n",
+            chip8_family_names[i],
+            (unsigned long long)chip->prof_count[i],
+            (unsigned long long)chip->prof_ticks[i],
+            (double)chip->prof_ticks[i] / (double)chip->prof_count[i],
+            total_ticks ? 100.0 * (double)chip->prof_ticks[i] / (double)total_ticks : 0.0);
+    }
+    fprintf(out, "%-16s %12llu %14llu\n", "total",
+        (unsigned long long)total_count, (unsigned long long)total_ticks);
+}
+
+// Appends one record to the execution trace ring buffer: a couple of plain stores, cheap enough
+// to stay enabled in production builds (unlike the old per-instruction DEBUG fprintf).
+static void chip8_trace_append(chip8_t* chip, uint16_t opcode) {
+    chip8_trace_rec* rec = &chip->trace[chip->trace_head & (CHIP8_TRACE_SIZE - 1)];
+    rec->pc = chip->pc;
+    rec->opcode = opcode;
+    rec->cycle = (uint32_t)chip->cycles;
+    chip->trace_head = (chip->trace_head + 1) & (CHIP8_TRACE_SIZE - 1);
+}
+
+void chip8_trace_dump(const chip8_t* chip, FILE* out) {
+    // The ring holds at most CHIP8_TRACE_SIZE records; fewer if the core just started
+    uint64_t count = (chip->cycles < CHIP8_TRACE_SIZE) ? chip->cycles : CHIP8_TRACE_SIZE;
+
+    // Walk from the oldest retained record to the newest
+    uint16_t index = (uint16_t)((chip->trace_head - count) & (CHIP8_TRACE_SIZE - 1));
+    for (uint64_t i = 0; i < count; i++) {
+        const chip8_trace_rec* rec = &chip->trace[index];
+        fprintf(out, "cycle %u: pc=0x%03X opcode=0x%04X\n", rec->cycle, rec->pc, rec->opcode);
+        index = (index + 1) & (CHIP8_TRACE_SIZE - 1);
+    }
+}
+
+// Decodes and executes a single already-fetched opcode. The program counter is updated by the
+// individual opcode handlers, so this function does no PC bookkeeping of its own.
+// Executes one already-decoded instruction: bookkeeping (trace, cycle count, optional
+// profiling) plus the handler call. `fn` must be the handler for `opcode` - either the
+// first-level table entry or a fully resolved one from the predecode cache.
+static void chip8_exec_fn(chip8_t* chip, uint16_t opcode, chip8_opcode_fn fn) {
+    chip8_trace_append(chip, opcode);
+    chip->cycles++;
+
+    if (chip->profiling) {
+        int family = opcode >> 12;
+        uint64_t t0 = chip8_prof_now();
+        fn(chip, opcode);
+        chip->prof_ticks[family] += chip8_prof_now() - t0;
+        chip->prof_count[family]++;
+        return;
+    }
+
+    fn(chip, opcode);
+}
+
+static void chip8_exec(chip8_t* chip, uint16_t opcode) {
+    chip8_exec_fn(chip, opcode, chip8_table_main[opcode >> 12]);
+}
+
+// Fetch-decode-execute at chip->pc, going through the predecode cache when one is attached.
+// Executes at most `budget` instructions and returns how many actually ran: with a cache this
+// is the translated basic block starting at the PC (capped to the budget so chip8_run batches
+// stay exact to the instruction), without one it is a single fetch/decode/execute. The caller
+// has already bounds-checked the PC. Odd program counters (possible but pathological) always
+// take the uncached path, so the cache only ever has to represent even addresses.
+static uint32_t chip8_fetch_exec(chip8_t* chip, uint32_t budget) {
+    uint16_t pc = chip->pc;
+
+    if (chip->dcache != NULL && (pc & 1) == 0) {
+        chip8_dcache_entry* entry = &chip->dcache->entries[pc >> 1];
+        if (entry->fn == NULL || entry->block_len == 0) {
+            // First execution of this address since the last invalidation: translate the
+            // basic block starting here once
+            chip8_dcache_translate(chip, pc);
+        }
+
+        // Run the block's records back-to-back. Every record before the last is straight-line
+        // code that advances the PC by exactly 2, so no fetch, decode or PC check happens
+        // between them - dispatch returns to this loop, not to the interpreter top.
+        uint32_t n = entry->block_len;
+        if (n > budget) {
+            n = budget;
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            chip8_exec_fn(chip, entry[k].opcode, entry[k].fn);
+        }
+        return n;
     }
 
+    // Fetch the current instruction from memory
+    uint16_t opcode = (chip->mem[pc] << 8) | chip->mem[pc + 1];
+    chip8_exec(chip, opcode);
+    return 1;
+}
+
+void chip8_tick_timers(chip8_t* chip) {
     // Decrement the delay timer if it's set
     if (chip->delay_timer > 0) {
         chip->delay_timer--;
     }
 
-    // Decrement the sound timer if it's set
+    // Decrement the sound timer if it's set. The core only flips the sound_playing flag here -
+    // actual audio output happens on the host's audio thread (see chip8_audio.h), so the
+    // emulation thread never blocks on sound I/O.
     if (chip->sound_timer > 0) {
         chip->sound_timer--;
+    }
+    chip->sound_playing = (chip->sound_timer > 0) ? 1 : 0;
+
+    // A timer tick may change the outcome of a parked delay-wait loop, so let the core
+    // re-evaluate it (a pure jump-to-self just re-parks itself on the next executed cycle)
+    chip->idle = 0;
+}
+
+// Latches a PC-out-of-bounds fault. Out of line because both callers below want their bounds
+// checks branch-predicted as never-taken.
+static chip8_status chip8_fault_pc(chip8_t* chip) {
+    chip->fault = CHIP8_ERR_PC_OOB;
+    chip->fault_pc = chip->pc;
+    return CHIP8_ERR_PC_OOB;
+}
+
+// Completes a parked Fx0A from the live keypad mask if a key is held down. This closes the
+// lost-wakeup window of the press-edge wake in chip8_set_key: a key pressed between the
+// handler's mask checks and the park finds waiting_key still clear, so no wake fires - but
+// as long as the key stays held, the next step/run call delivers it from here.
+static void chip8_waiting_key_poll(chip8_t* chip) {
+    uint16_t live = chip->keypad;
+    if (live) {
+        chip->V[chip->waiting_key_reg] = (uint8_t)chip8_ctz16(live);
+        chip->waiting_key = 0;
+        chip->pc += 2;
+    }
+}
+
+chip8_status chip8_step(chip8_t* chip) {
+    // A previously latched fault halts the instance until the host clears it (by reloading a
+    // ROM or resetting chip->fault); report it again rather than re-executing the fault.
+    if (chip->fault) {
+        return (chip8_status)chip->fault;
+    }
+
+    // The upper bound is CHIP8_MEM_SIZE - 1, not CHIP8_MEM_SIZE: the fetch reads two bytes,
+    // so pc == 0xFFF (reachable via JP 0xFFF) would assemble an opcode from one byte past
+    // the end of mem
+    if (chip->pc < CHIP8_PROGRAM_OFFSET || chip->pc >= CHIP8_MEM_SIZE - 1) {
+        return chip8_fault_pc(chip);
+    }
+
+    // Halted on Fx0A (until chip8_set_key delivers a key, or a held key is picked up from
+    // the live mask here) or parked in a detected spin loop (until a key or timer event can
+    // change the outcome): nothing to do
+    if (chip->waiting_key) {
+        chip8_waiting_key_poll(chip);
+    }
+    if (chip->waiting_key || chip->idle) {
+        return CHIP8_OK;
+    }
 
-        // Play a sound if the sound timer just reached zero
-        if (chip->sound_timer == 0) {
-            printf("BEEP!\n");
+    // Latch the live keypad mask so this instruction and a whole chip8_run batch see input
+    // the same way
+    chip->keypad_latch = chip->keypad;
+
+    chip8_fetch_exec(chip, 1);
+    return (chip8_status)chip->fault;
+}
+
+chip8_status chip8_run(chip8_t* chip, uint32_t cycles) {
+    // A previously latched fault halts the instance until the host clears it
+    if (chip->fault) {
+        return (chip8_status)chip->fault;
+    }
+
+    // Validate the program counter once for the whole batch instead of per instruction (the
+    // two-byte fetch makes CHIP8_MEM_SIZE - 1 the first out-of-bounds address, matching the
+    // in-loop guard below and chip8_step)
+    if (chip->pc < CHIP8_PROGRAM_OFFSET || chip->pc >= CHIP8_MEM_SIZE - 1) {
+        return chip8_fault_pc(chip);
+    }
+
+    // Halted on Fx0A (unless a held key can be picked up from the live mask) or parked in a
+    // detected spin loop: the whole batch is a no-op until a key or timer event wakes the
+    // core, so a pool full of finished or waiting instances costs nearly nothing.
+    if (chip->waiting_key) {
+        chip8_waiting_key_poll(chip);
+    }
+    if (chip->waiting_key || chip->idle) {
+        return CHIP8_OK;
+    }
+
+    // Latch the live keypad mask once for the whole batch: the key-test opcodes read the
+    // latch, so an input thread flipping bits mid-batch cannot make two tests of the same key
+    // disagree, and a recorded run replays identically as long as events land on batch
+    // boundaries.
+    chip->keypad_latch = chip->keypad;
+
+    for (uint32_t i = 0; i < cycles; ) {
+        // Opcode handlers can move the PC anywhere, so a cheap one-sided guard is still needed
+        // to keep the fetch below inside `mem`; anything more expensive stays hoisted above.
+        if (chip->pc >= CHIP8_MEM_SIZE - 1) {
+            return chip8_fault_pc(chip);
+        }
+
+        // One translated basic block (or one instruction without a cache) per round trip
+        i += chip8_fetch_exec(chip, cycles - i);
+
+        // A bad opcode latched a fault mid-batch: stop and report it
+        if (chip->fault) {
+            return (chip8_status)chip->fault;
+        }
+
+        // An Fx0A just entered the wait state or a spin loop was detected: skip the rest of
+        // the batch
+        if (chip->waiting_key || chip->idle) {
+            break;
         }
     }
+    return CHIP8_OK;
 }
 
 
@@ -282,8 +1112,12 @@ void chip8_step(chip8_t* chip) {
 
 // 00E0 - CLS: Clear the display.
 void chip8_CLS(chip8_t* chip) {
-    // Clear the display buffer by setting all pixels to 0
+    // Clear the display buffers by setting all pixels to 0. The packed buffer makes the
+    // monochrome clear a 256-byte memset; the byte buffer is still cleared for color mode.
     memset(chip->display, 0, sizeof(chip->display));
+    memset(chip->display64, 0, sizeof(chip->display64));
+    // Every row changed, so mark them all dirty for the renderer
+    chip->dirty_rows = 0xFFFFFFFF;
     chip->pc += 2;
 }
 
@@ -296,6 +1130,24 @@ void chip8_RET(chip8_t* chip) {
 
 // 1nnn - JP addr: Jump to address `nnn`.
 void chip8_JP_addr(chip8_t* chip, uint16_t addr) {
+    // Spin-loop detection. A jump to itself (the classic end-of-program halt, also the "0000"
+    // padding pattern once it traps) can never make progress on its own, and the classic
+    // delay-timer wait
+    //     loop: Fx07        ; Vx = DT
+    //           3xkk / 4xkk ; skip out of the loop on the wanted value
+    //           1nnn loop
+    // can only change outcome when the delay timer ticks. Both park the core in the idle
+    // state: chip8_step/chip8_run skip cycles while `idle` is set, and chip8_set_key /
+    // chip8_tick_timers clear it (re-running the loop once per event re-evaluates the exit
+    // condition, or harmlessly re-enters idle).
+    if (addr == chip->pc) {
+        chip->idle = 1;
+    }
+    else if (addr == (uint16_t)(chip->pc - 4) &&
+        (chip->mem[addr] & 0xF0) == 0xF0 && chip->mem[addr + 1] == 0x07) {
+        chip->idle = 1;
+    }
+
     // Jump to the address specified by the instruction by setting the program counter to that address
     chip->pc = addr;
 }
@@ -466,11 +1318,17 @@ void chip8_JP_V0_addr(chip8_t* chip, uint16_t addr) {
 
 // Cxkk - RND Vx, byte: Set Vx = random byte AND kk.
 void chip8_RND_Vx_byte(chip8_t* chip, uint8_t x, uint8_t kk) {
-    // Generate a random byte using the rand() function from the C standard library
-    uint8_t rand_byte = rand() & 0xFF;
+    // Advance the per-instance xorshift32 generator: three shifts and three XORs, no shared
+    // state (libc rand() takes a lock on some platforms and serializes concurrent instances),
+    // and fully reproducible from the seed passed to chip8_seed
+    uint32_t r = chip->rng;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    chip->rng = r;
 
     // Set register Vx to the result of the bitwise AND operation between the random byte and the byte kk
-    chip->V[x] = rand_byte & kk;
+    chip->V[x] = (uint8_t)r & kk;
 
     chip->pc += 2;
 }
@@ -494,6 +1352,9 @@ void chip8_DRW_Vx_Vy_nibble(chip8_t* chip, uint8_t x, uint8_t y, uint8_t height)
             // Get the pixel value from memory
             pixel = chip->mem[index + i];
 
+            // Mark the touched display row dirty for the renderer
+            chip->dirty_rows |= 1u << ((chip->V[y] + i) % CHIP8_DISPLAY_HEIGHT);
+
             // Loop through each column of the sprite (4 pixels per byte)
             for (j = 0; j < 4; j++) {
                 // Extract the color index for the current pixel (4 bits per pixel)
@@ -523,38 +1384,52 @@ void chip8_DRW_Vx_Vy_nibble(chip8_t* chip, uint8_t x, uint8_t y, uint8_t height)
         }
     }
     else {
-        // Original Chip-8 implementation (1 bit per pixel)
+        // Original Chip-8 implementation (1 bit per pixel), drawn into the packed display:
+        // each sprite row is blitted as one rotate + XOR into the row's uint64_t instead of
+        // 8 separate byte loads/stores, with the collision test done via the pre-XOR AND.
+        uint8_t xpos = chip->V[x] % CHIP8_DISPLAY_WIDTH;
+        uint8_t ypos = chip->V[y] % CHIP8_DISPLAY_HEIGHT;
+
+        // Collision bits and touched rows are accumulated in locals and stored once after the
+        // loop, so the loop body is pure register arithmetic plus the display row load/store -
+        // no branches and no per-row writes to chip8_t fields.
+        uint64_t collision = 0;
+        uint32_t dirty = 0;
 
         // Loop through each row of the sprite
         for (i = 0; i < height; i++) {
             // Get the pixel value from memory
             pixel = chip->mem[index + i];
 
-            // Loop through each column of the sprite
-            for (j = 0; j < 8; j++) {
-                // Check if the current pixel is on
-                if ((pixel & (0x80 >> j)) != 0) {
-                    // Calculate the screen buffer index for the current pixel
-                    uint16_t buffer_index = (chip->V[x] + j) + ((chip->V[y] + i) * CHIP8_DISPLAY_WIDTH);
+            uint8_t row = (ypos + i) % CHIP8_DISPLAY_HEIGHT;
 
-                    // Check if the pixel is already set
-                    if (chip->display[buffer_index] == 1) {
-                        // Set VF to 1 (collision detected)
-                        chip->V[0xF] = 1;
-                    }
+            // Place the 8 sprite bits at the x position: a rotate-right by xpos covers both
+            // the aligned case and the wrap around the row edge in one branchless expression
+            // (compilers recognize the idiom and emit a single rotate instruction)
+            uint64_t sprite_bits = (uint64_t)pixel << 56;
+            uint64_t row_bits = (sprite_bits >> xpos) | (sprite_bits << ((64 - xpos) & 63));
 
-                    // XOR the pixel onto the screen buffer
-                    chip->display[buffer_index] ^= 1;
-                }
-            }
+            // Any bit that is set both in the sprite and on screen is a collision
+            collision |= chip->display64[row] & row_bits;
+
+            // XOR the whole sprite row onto the screen buffer
+            chip->display64[row] ^= row_bits;
+
+            dirty |= 1u << row;
         }
+
+        // Set VF if any sprite pixel landed on a lit pixel, and mark the touched display rows
+        // dirty for the renderer
+        chip->V[0xF] = (collision != 0) ? 1 : 0;
+        chip->dirty_rows |= dirty;
     }
     chip->pc += 2;
 }
 
 // Ex9E - SKP Vx: Skip next instruction if key with the value of Vx is pressed.
 void chip8_SKP_Vx(chip8_t* chip, uint8_t x) {
-    if (chip->keypad[chip->V[x]]) {
+    // One bit test against the input state latched at the start of the batch
+    if (chip->keypad_latch & (uint16_t)(1u << (chip->V[x] & 0xF))) {
         // Skip the next instruction by incrementing the program counter by 4
         chip->pc += 4;
     }
@@ -567,7 +1442,7 @@ void chip8_SKP_Vx(chip8_t* chip, uint8_t x) {
 // ExA1 - SKNP Vx: Skip next instruction if key with the value of Vx is not pressed.
 void chip8_SKNP_Vx(chip8_t* chip, uint8_t x) {
     // If the key with the value of Vx is not pressed, skip the next instruction
-    if (!chip->keypad[chip->V[x]]) {
+    if (!(chip->keypad_latch & (uint16_t)(1u << (chip->V[x] & 0xF)))) {
         // Skip the next instruction by incrementing the program counter by 4
         chip->pc += 4;
     }
@@ -586,24 +1461,28 @@ void chip8_LD_Vx_DT(chip8_t* chip, uint8_t x) {
 
 // Fx0A - LD Vx, K: Wait for a key press, store the value of the key in Vx.
 void chip8_LD_Vx_K(chip8_t* chip, uint8_t x) {
-    // Check if any key is pressed
-    int key_pressed = 0;
-    for (int i = 0; i < 16; i++) {
-        if (chip->keypad[i]) {
-            // A key is pressed, store its value in register Vx
-            chip->V[x] = i;
-            key_pressed = 1;
-            break;
-        }
+    // Any-key-pressed is one mask test; the lowest set bit picks the same key the old
+    // ascending array scan did. If the batch latch is empty, fall back to the live atomic
+    // mask before parking: a key pressed after the latch was taken and still held now would
+    // otherwise be missed entirely - the wake in chip8_set_key only fires on a press edge
+    // while waiting_key is already set, so parking here with that key down would strand the
+    // core until the key was released and pressed again (a lost wakeup).
+    uint16_t mask = chip->keypad_latch;
+    if (mask == 0) {
+        mask = chip->keypad;
     }
-
-    // If no key is pressed, do not increment the program counter
-    if (!key_pressed) {
+    if (mask) {
+        chip->V[x] = (uint8_t)chip8_ctz16(mask);
+        chip->pc += 2;
         return;
     }
 
-    // Otherwise, increment the program counter by 2 to go to the next instruction
-    chip->pc += 2;
+    // No key is pressed: enter the halted-waiting-for-key state instead of re-executing this
+    // instruction every cycle. The PC stays on the Fx0A; chip8_step/chip8_run skip cycles
+    // while waiting_key is set, and chip8_set_key completes the instruction when a key
+    // arrives. A core blocked here costs nothing.
+    chip->waiting_key = 1;
+    chip->waiting_key_reg = x;
 }
 
 // Fx15 - LD DT, Vx: Set delay timer = Vx.
@@ -615,6 +1494,9 @@ void chip8_LD_DT_Vx(chip8_t* chip, uint8_t x) {
 // Fx18 - LD ST, Vx: Set sound timer = Vx.
 void chip8_LD_ST_Vx(chip8_t* chip, uint8_t x) {
     chip->sound_timer = chip->V[x];
+
+    // Raise the beep flag immediately so the tone starts on this tick, not the next timer tick
+    chip->sound_playing = (chip->sound_timer > 0) ? 1 : 0;
     chip->pc += 2;
 }
 
@@ -644,6 +1526,11 @@ void chip8_LD_B_Vx(chip8_t* chip, uint8_t x) {
     chip->mem[chip->I] = value / 100;        // Hundreds digit
     chip->mem[chip->I + 1] = (value / 10) % 10;  // Tens digit
     chip->mem[chip->I + 2] = value % 10;         // Ones digit
+
+    // Drop any decoded records covering the written bytes (self-modifying code) and remember
+    // the granules for the next reset
+    chip8_dcache_invalidate(chip, chip->I, 3);
+    chip8_mem_mark(chip, chip->I, 3);
     chip->pc += 2;
 }
 
@@ -652,6 +1539,11 @@ void chip8_LD_I_Vx(chip8_t* chip, uint8_t x) {
     for (uint8_t i = 0; i <= x; i++) {
         chip->mem[chip->I + i] = chip->V[i];
     }
+
+    // Drop any decoded records covering the written bytes (self-modifying code) and remember
+    // the granules for the next reset
+    chip8_dcache_invalidate(chip, chip->I, (uint16_t)(x + 1));
+    chip8_mem_mark(chip, chip->I, (uint16_t)(x + 1));
     chip->I += x + 1;
     chip->pc += 2;
 }
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 /*
 * List of chip8 instructions:
@@ -158,9 +159,55 @@
 
 // Chip 8 programs are loaded at memory address 0x200
 #define CHIP8_PROGRAM_OFFSET 0x200
+// Granule size of the memory dirty mask (see mem_dirty / chip8_reset_from). 4K of memory in
+// 256-byte granules fits the mask in one uint16_t, and a granule matches the footprint of the
+// largest single store burst (Fx55 writes at most 16 bytes) closely enough that a typical
+// non-self-modifying game dirties one or two granules over its whole run.
+#define CHIP8_MEM_GRANULE 256
+// Number of records the execution trace ring buffer holds (must be a power of two; the write
+// index is masked with CHIP8_TRACE_SIZE - 1 instead of taking a modulo)
+#define CHIP8_TRACE_SIZE 256
+
+// One record of the execution trace: which opcode was fetched from which address, and on which
+// cycle (instruction count) it executed. At 8 bytes per record the whole ring is 2 KB.
+typedef struct {
+    uint16_t pc;
+    uint16_t opcode;
+    uint32_t cycle;
+} chip8_trace_rec;
 // This value can be adjusted based on the desired speed of the emulator. A higher value will result in slower emulation, while a lower value will result in faster emulation.
 #define CHIP8_CYCLES_PER_FRAME 20
 
+// Status codes returned by chip8_step/chip8_run. On the first error the interpreter latches
+// the code plus the faulting PC (and, for a bad opcode, the opcode itself) into the fault
+// fields of chip8_t and halts: later step/run calls return the latched code without executing
+// anything and without any I/O, so a faulting ROM in a farm costs nothing instead of flooding
+// stderr at full interpreter speed. The host decides what to do with a fault - log it, dump
+// the trace, retire the instance. chip8_init and the ROM loaders clear the fault; a host that
+// repairs the machine state by hand resets chip->fault to CHIP8_OK itself.
+typedef enum {
+    CHIP8_OK = 0,           // the batch ran (possibly cut short by a key-wait or idle park)
+    CHIP8_ERR_BAD_OPCODE,   // fetched an opcode the dispatch tables do not implement
+    CHIP8_ERR_PC_OOB        // the program counter left the executable address range
+} chip8_status;
+
+// Quirks profiles. The classic interpreters disagree on a few instructions - whether
+// 8xy6/8xyE shift Vy or Vx, and whether Fx55/Fx65 leave I incremented - and ROMs written for
+// one lineage break on the other. Each profile is a complete set of pre-filled dispatch table
+// slots with the right handler variants already installed, so selecting one costs nothing in
+// the per-instruction path (no quirk branches inside any handler). Select per instance with
+// chip8_set_quirks; the profile travels with snapshots.
+typedef enum {
+    CHIP8_QUIRKS_DEFAULT = 0,   // this interpreter's historical behavior: shifts use Vx, Fx55/Fx65 increment I
+    CHIP8_QUIRKS_COSMAC,        // original COSMAC VIP: 8xy6/8xyE shift Vy into Vx, Fx55/Fx65 increment I
+    CHIP8_QUIRKS_SCHIP,         // SUPER-CHIP lineage: shifts use Vx, Fx55/Fx65 leave I unchanged
+    CHIP8_QUIRKS_COUNT
+} chip8_quirks;
+
+// Opaque predecode cache (see chip8_dcache_enable); lives outside chip8_t so snapshots never
+// contain host function pointers
+struct chip8_dcache;
+
 typedef struct {
     uint8_t mem[CHIP8_MEM_SIZE];        // Memory (4K)
     uint8_t V[CHIP8_NUM_REGS];          // Registers (V0-VF)
@@ -170,14 +217,69 @@ typedef struct {
     uint8_t sound_timer;                // Sound timer (8-bit)
     uint16_t stack[CHIP8_STACK_SIZE];   // Stack (16 levels)
     uint16_t sp;                        // Stack pointer (16-bit)
-    uint8_t keypad[16];                 // Keypad state (16 keys)
+    uint16_t keypad;                    // Live keypad bitmask (bit n set = key n down), written by chip8_set_key with one atomic OR/AND so the host input thread never tears it
+    uint16_t keypad_latch;              // Keypad mask latched from `keypad` at the top of each chip8_step/chip8_run batch; the key-test opcodes read this, so a whole batch sees one consistent input state
     uint8_t colorMode;                  // NEW: color mode register if set: color mode on (16 colors), if not set: color mode off (2 colors - monochrome)
+    uint8_t sound_playing;              // Set while the sound timer is nonzero; the host forwards it to chip8_audio_update (the core never does audio I/O)
+    uint8_t waiting_key;                // Set while an Fx0A is blocked waiting for a key press; chip8_step/chip8_run skip cycles until chip8_set_key delivers one (or pick up a still-held key from the live mask themselves)
+    uint8_t waiting_key_reg;            // Destination register Vx of the pending Fx0A (valid only while waiting_key is set)
+    uint8_t idle;                       // Set when the core is parked in a detected spin loop (jump-to-self or delay-timer wait); cleared by key and timer events
+    uint8_t fault;                      // Latched chip8_status of the first error (CHIP8_OK while healthy); chip8_step/chip8_run halt while nonzero
+    uint16_t fault_pc;                  // PC at the time the fault was latched (valid while fault is nonzero)
+    uint16_t fault_opcode;              // The faulting opcode, for CHIP8_ERR_BAD_OPCODE
+    uint8_t quirks;                     // Active chip8_quirks profile; indexes the per-profile dispatch tables (see chip8_set_quirks)
+    uint16_t mem_dirty;                 // Bitmask of CHIP8_MEM_GRANULE-sized memory granules written since the last chip8_reset_from (bit n = granule n); maintained by the store paths and the ROM loaders
+    uint32_t dirty_rows;                // Bitmask of display rows written since the renderer last consumed them (bit n = row n)
+    uint64_t cycles;                    // Total instructions executed since chip8_init
+    uint32_t rng;                       // Per-instance xorshift32 PRNG state for Cxkk (never zero; seed via chip8_seed)
+    uint8_t profiling;                  // When set, chip8_step/chip8_run fill prof_count/prof_ticks (see chip8_profile_enable)
+    uint64_t prof_count[16];            // Executed instructions per opcode family (indexed by the opcode high nibble)
+    uint64_t prof_ticks[16];            // Accumulated rdtsc/clock ticks per opcode family
+    uint16_t trace_head;                // Next write index into the trace ring (masked with CHIP8_TRACE_SIZE - 1)
+    chip8_trace_rec trace[CHIP8_TRACE_SIZE]; // Always-on execution trace of the last CHIP8_TRACE_SIZE instructions
     uint8_t display[CHIP8_DISPLAY_BUFFER_SIZE];
+    // Packed monochrome display: one uint64_t per row, one bit per pixel (bit 63 - x = pixel x),
+    // so the whole screen is 256 bytes (four cache lines). In monochrome mode this is the buffer
+    // chip8_DRW_Vx_Vy_nibble draws into, an 8-pixel sprite row being a single shift + XOR with
+    // the collision test done via the pre-XOR AND. Color mode keeps using the byte-per-pixel
+    // `display` buffer above; monochrome renderers expand this one with chip8_display_unpack.
+    uint64_t display64[CHIP8_DISPLAY_HEIGHT];
+    // Completed-frame front buffer (byte per pixel in both modes). chip8_present copies the
+    // working display above into it under the display_seq seqlock at frame boundaries, so a
+    // renderer on another thread reads whole frames with chip8_display_read - never a
+    // half-drawn sprite - while the interpreter keeps drawing.
+    uint8_t display_front[CHIP8_DISPLAY_BUFFER_SIZE];
+    uint32_t display_seq;               // Seqlock counter over display_front: odd while a present is in progress
+    uint32_t display_frame;             // Number of completed presents; lets a renderer skip unchanged frames
+    // Optional predecode cache, NULL unless the host called chip8_dcache_enable. This is the
+    // one non-machine-state field in the struct: chip8_restore keeps the live instance's
+    // pointer (and flushes the cache) instead of adopting the snapshotted value, so snapshots
+    // stay portable across processes.
+    struct chip8_dcache* dcache;
 } chip8_t;
 
+// Magic number ("CH8S") and version of the snapshot format. The version must be bumped
+// whenever the chip8_t layout changes, so a restore never pours an old layout into a new
+// struct. The snapshot body is a verbatim copy of chip8_t (the struct is flat POD with no
+// pointers), which is what makes snapshot/restore run at memcpy speed.
+#define CHIP8_SNAPSHOT_MAGIC 0x53384843u
+#define CHIP8_SNAPSHOT_VERSION 12
+
+// Header placed in front of the raw chip8_t bytes in a snapshot buffer. Kept explicit (rather
+// than implied by the build) so snapshots written to disk can be validated when read back.
+typedef struct {
+    uint32_t magic;     // CHIP8_SNAPSHOT_MAGIC
+    uint32_t version;   // CHIP8_SNAPSHOT_VERSION at the time the snapshot was taken
+    uint32_t size;      // sizeof(chip8_t) at the time the snapshot was taken
+} chip8_snapshot_header;
+
+// Total size in bytes of one snapshot (header + raw machine state); buffers passed to
+// chip8_snapshot/chip8_restore must be at least this large
+#define CHIP8_SNAPSHOT_SIZE (sizeof(chip8_snapshot_header) + sizeof(chip8_t))
+
 // The chip8_key enum is a list of constants that represent the keys of a Chip-8 keypad.
-// In the context of a Chip-8 emulator, the keypad is typically represented as an array of 16 elements,
-// with each element corresponding to a specific key. The values of the chip8_key constants are simply indices into this array,
+// The keypad state is kept as a 16-bit mask with one bit per key, and the values of the
+// chip8_key constants are the bit indices into that mask,
 // allowing the emulator to easily determine which key is being pressed or released.
 typedef enum {
     CHIP8_KEY_0,
@@ -217,22 +319,178 @@ void chip8_init(chip8_t* chip);
 
 // If the ROM file is small enough to fit into memory, the function reads the contents of the file into a buffer located in the emulator's memory starting at the CHIP8_PROGRAM_OFFSET address,
 // which is the beginning of the program memory region. Finally, the function closes the ROM file.
+//
+// The file is read through a small in-memory ROM cache: the first load of a given filename reads
+// the file from disk, every later load (from any instance) copies the cached image instead, so
+// spinning up many instances of the same game touches the filesystem only once.
 bool chip8_load_rom(chip8_t* chip, const char* filename);
 
-// This function fetches the current opcode, increments the program counter, decodes and executes the opcode,
-// decrements the delayand sound timers if they are set, and plays a sound if the sound timer just reached zero (currently only prints BEEP).
-// If the opcode is not recognized, the function prints an error message.
-void chip8_step(chip8_t* chip);
+// This function loads an already in-memory ROM image into the emulator's program memory, checking
+// that it fits below the end of the 4K address space. It is the workhorse behind chip8_load_rom
+// and the natural entry point for hosts that generate programs on the fly or share one ROM buffer
+// between many instances.
+bool chip8_load_rom_from_memory(chip8_t* chip, const uint8_t* data, size_t len);
+
+// This function returns the shared, read-only image of the given ROM file from the cache, reading
+// the file from disk only on the first request. Returns NULL (and prints an error for I/O
+// failures) if the file cannot be read or the cache is full, in which case the caller should fall
+// back to reading the file itself. The returned buffer stays valid until chip8_rom_cache_clear.
+const uint8_t* chip8_rom_cache_get(const char* filename, size_t* out_len);
+
+// This function frees every ROM image held by the cache. Any pointers previously handed out by
+// chip8_rom_cache_get become invalid.
+void chip8_rom_cache_clear(void);
+
+// This function fetches the current opcode, increments the program counter, and decodes and
+// executes the opcode. It returns CHIP8_OK on success; an unrecognized opcode or an
+// out-of-bounds program counter latches the fault fields of chip8_t and returns the matching
+// error code (see chip8_status), with no output of any kind from the interpreter itself.
+// The delay/sound timers are NOT touched here: they run at 60 Hz real time, not per
+// instruction, so the host calls chip8_tick_timers for them separately.
+chip8_status chip8_step(chip8_t* chip);
+
+// This function executes a whole batch of `cycles` instructions in one tight internal loop.
+// It behaves like calling chip8_step `cycles` times, but the program counter bounds check is
+// validated once up front, which makes it the preferred entry point for hosts that run a fixed
+// number of cycles per frame (or headless at full speed). It returns CHIP8_OK if the batch
+// ran to completion (or parked on a key-wait or idle loop), otherwise the chip8_status of the
+// fault that cut it short.
+chip8_status chip8_run(chip8_t* chip, uint32_t cycles);
+
+// This function decrements the delay and sound timers by one tick if they are set, and keeps
+// the sound_playing flag raised while the sound timer is above zero - the core never does
+// audio I/O itself; the host forwards the flag to chip8_audio_update, which starts and stops
+// the tone. The Chip-8 timers run at 60 Hz of real time regardless of how many instructions
+// execute, so the host calls this at 60 Hz (e.g. once per frame) rather than the interpreter
+// ticking timers per instruction - which both fixes delay-timer-based game speed and keeps
+// two branches out of the instruction hot path.
+void chip8_tick_timers(chip8_t* chip);
 
 // This function checks if the chip8_key value passed in is a valid key value (between CHIP8_KEY_0 and CHIP8_KEY_F),
-// and sets the corresponding element in the chip->keypad array to the state value passed in.
-void chip8_set_key(chip8_t* chip, uint8_t key, uint8_t state);
+// and sets or clears the corresponding bit of the chip->keypad bitmask with a single atomic
+// OR/AND, so it is safe to call from an input thread while the emulation thread is running a
+// batch. The running batch keeps the input state it latched at its start; the new mask is
+// picked up at the next chip8_step/chip8_run call. A press additionally wakes a core halted
+// on Fx0A; a press that races the park itself lands in the live mask and is delivered from
+// there at the next step/run call, so a held key can never be lost to the race.
+void chip8_set_key(chip8_t* chip, chip8_key key, uint8_t state);
+
+// This function selects the quirks profile for this instance (chip8_init starts every
+// instance on CHIP8_QUIRKS_DEFAULT; out-of-range values fall back to it too). The profile is
+// applied by switching which pre-filled copy of the dispatch tables the instance indexes, so
+// the affected instructions run their variant handlers with no quirk checks at execution
+// time. Changing the profile flushes the predecode cache, since cached records resolve to one
+// profile's handlers; call it once after loading the ROM, not mid-run.
+void chip8_set_quirks(chip8_t* chip, chip8_quirks quirks);
+
+// This function returns the bitmask of display rows that were written since the last call (bit n
+// set means row n of the display buffer changed) and clears the mask for the next frame.
+// chip8_CLS and chip8_DRW_Vx_Vy_nibble maintain the mask as they write the display buffer, so a
+// renderer can call this once per frame, skip redrawing entirely when it returns 0, and otherwise
+// only redraw the rows whose bits are set.
+uint32_t chip8_take_dirty_rows(chip8_t* chip);
+
+// This function turns instruction profiling on or off for this instance. While enabled, every
+// executed instruction is counted per opcode family and the time spent in its handler
+// (rdtsc on x86, clock() elsewhere) is accumulated per family; while disabled the hot path
+// pays only a single predictable branch. Profiling data survives toggling; use
+// chip8_profile_reset to start a fresh measurement window.
+void chip8_profile_enable(chip8_t* chip, bool enable);
+
+// This function clears the accumulated per-family instruction counts and tick totals.
+void chip8_profile_reset(chip8_t* chip);
+
+// This function attaches (enable = true) or frees (enable = false) a predecode cache for this
+// instance. While attached, chip8_step/chip8_run decode each program address only once: the
+// cache holds one {handler, opcode} record per even address, filled lazily on first execution,
+// so tight game loops run as an indexed load plus an indirect call instead of re-fetching and
+// re-decoding the same opcodes forever. Self-modifying code is handled by invalidating the
+// touched addresses on every memory write (Fx55/Fx33) and on every ROM load or restore.
+// Enabling is a calloc; if the allocation fails the instance simply keeps decoding the old way.
+void chip8_dcache_enable(chip8_t* chip, bool enable);
+
+// This function discards every decoded record in the attached cache (a no-op without one).
+// The interpreter calls it on ROM loads and restores; hosts that poke chip->mem directly must
+// call it themselves before resuming execution.
+void chip8_dcache_flush(chip8_t* chip);
+
+// This function writes a profiling report to `out`: one line per executed opcode family with
+// its execution count, total and per-instruction tick cost, and share of the measured time.
+// Use it to see where interpreter time actually goes in a given ROM (and to pick a sensible
+// CHIP8_CYCLES_PER_FRAME) instead of guessing.
+void chip8_profile_report(const chip8_t* chip, FILE* out);
+
+// This function seeds the per-instance random number generator used by the Cxkk (RND)
+// instruction. Two instances seeded identically and fed identical input produce identical runs,
+// which is what makes fuzzing and record/replay reproducible. A seed of 0 is mapped to the
+// default seed, since the xorshift generator would get stuck on an all-zero state.
+void chip8_seed(chip8_t* chip, uint32_t seed);
+
+// This function writes a complete checkpoint of the machine state into `buf` (which must be at
+// least CHIP8_SNAPSHOT_SIZE bytes): a versioned header followed by the raw chip8_t bytes.
+// Because chip8_t is a flat POD struct this is a single memcpy, so a checkpoint taken once
+// (e.g. right after chip8_init + chip8_load_rom) can be restored millions of times without
+// ever touching the ROM file again.
+void chip8_snapshot(const chip8_t* chip, void* buf);
+
+// This function restores the machine state from a buffer previously filled by chip8_snapshot.
+// It validates the header (magic, format version, struct size) and returns false without
+// touching `chip` if the snapshot was taken by an incompatible build.
+bool chip8_restore(chip8_t* chip, const void* buf);
+
+// This function resets `chip` back to the state of `golden` while copying only what actually
+// diverged: the registers, timers, stack, display and bookkeeping are copied wholesale (they
+// are small and almost always dirty), but of the 4K memory only the granules `chip` wrote
+// since its last reset are copied back (the store paths and ROM loaders maintain the
+// mem_dirty mask). For a pool of instances all running from the same golden image that cuts a
+// reset from a full 4K memory copy to a couple of hundred bytes, which is what keeps a
+// many-instance pool's hot state resident in cache instead of streaming the identical font
+// and ROM bytes through it on every reset. Requires that `chip` already held a copy of
+// `golden`'s memory (chip8_init marks all granules dirty, so a freshly initialized instance's
+// first reset copies everything); to re-target an instance at a *different* golden, set
+// chip->mem_dirty to 0xFFFF first. Like chip8_restore this keeps the instance's own predecode
+// cache and flushes it.
+void chip8_reset_from(chip8_t* chip, const chip8_t* golden);
+
+// This function writes the execution trace ring buffer to `out`, oldest record first, one line
+// per record (cycle, pc, opcode). The interpreter appends a record for every instruction it
+// fetches with a couple of plain stores, so tracing is always on at near-zero cost and the last
+// CHIP8_TRACE_SIZE instructions can be dumped on demand (e.g. after a crash or a bad opcode)
+// without the per-instruction stderr I/O a DEBUG build used to pay for.
+void chip8_trace_dump(const chip8_t* chip, FILE* out);
+
+// This function expands the packed monochrome display (display64, one bit per pixel) into the
+// byte-per-pixel `display` buffer, so renderers written against the byte buffer keep working
+// unchanged. Only needed in monochrome mode; in color mode the byte buffer is authoritative.
+void chip8_display_unpack(chip8_t* chip);
+
+// This function publishes the current display as a completed frame: it copies the working
+// buffer (expanding the packed monochrome rows) into display_front under the seqlock, so the
+// copy is the only cost and no lock is ever held. The emulation thread calls it at frame
+// boundaries - after a batch, never mid-instruction - which is what guarantees a renderer can
+// never observe a half-drawn sprite.
+void chip8_present(chip8_t* chip);
+
+// This function copies the last presented frame into `out` (CHIP8_DISPLAY_BUFFER_SIZE bytes,
+// one per pixel; in color mode each byte packs two 4-bit pixels exactly like the working
+// buffer). Safe to call from a render thread while the emulation thread runs: the seqlock
+// retry rereads if a present raced the copy. Returns false until the first present; `frame`
+// (optional, may be NULL) receives the present counter so callers can skip unchanged frames.
+bool chip8_display_read(const chip8_t* chip, uint8_t* out, uint32_t* frame);
 
 
 // ############################################################################################################
 // Opcode handlers
 // ############################################################################################################
 
+// Signature of a dispatch-table opcode handler: the full 16-bit opcode is passed in and the
+// handler is responsible for extracting its own operands (x, y, kk, nnn) and updating the PC.
+// The interpreter decodes by indexing a precomputed table of these with the opcode bits, so
+// decode is one table load and one indirect call instead of a nested switch. The functions
+// declared below remain the single implementation of each instruction; the dispatch layer in
+// chip8.c only wraps them.
+typedef void (*chip8_opcode_fn)(chip8_t* chip, uint16_t opcode);
+
 // 00E0 - CLS: Clear the display.
 //
 // This function simply sets all the pixels in the display buffer to 0, effectively clearing the screen.
@@ -0,0 +1,275 @@
+// Must precede every system header so <time.h> exposes nanosleep under -std=c99
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "chip8_audio.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Thin portability layer over Win32 threads / pthreads, same shape as in chip8_pool.c. The
+// audio module only needs a thread handle and a millisecond sleep - the queue itself is
+// lock-free, so there is no mutex or condition variable here.
+#if defined(_WIN32)
+
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+
+typedef HANDLE chip8_thread;
+
+static void chip8_sleep_ms(uint32_t ms) {
+    Sleep(ms);
+}
+
+#else
+
+#include <pthread.h>
+#include <time.h>
+
+typedef pthread_t chip8_thread;
+
+static void chip8_sleep_ms(uint32_t ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+#endif
+
+// Beep events the emulation thread posts into the queue
+typedef enum {
+    CHIP8_AUDIO_EVENT_START = 1,
+    CHIP8_AUDIO_EVENT_STOP = 2
+} chip8_audio_event;
+
+// Queue capacity. Events are only posted on beep edges (at most two per timer tick), so even a
+// consumer that oversleeps for a whole second cannot fall this far behind; if the queue is ever
+// full anyway, chip8_audio_update drops the event rather than block the emulation thread.
+#define CHIP8_AUDIO_QUEUE_SIZE 64
+
+// Square wave parameters: classic Chip-8 buzzer pitch, small buffers so start/stop latency
+// stays under ~25 ms.
+#define CHIP8_AUDIO_SAMPLE_RATE 44100
+#define CHIP8_AUDIO_TONE_HZ 440
+#define CHIP8_AUDIO_BUFFER_SAMPLES 1024
+#define CHIP8_AUDIO_NUM_BUFFERS 2
+#define CHIP8_AUDIO_AMPLITUDE 6000
+
+struct chip8_audio {
+    // Single-producer single-consumer lock-free ring. `head` is written only by the emulation
+    // thread, `tail` only by the audio thread; each side reads the other's index at most once
+    // per operation, and the indices are kept volatile so those reads are not hoisted out of
+    // the polling loops. With one producer and one consumer that is all the synchronization an
+    // index-passing ring needs.
+    volatile uint32_t head;             // next write slot (producer-owned)
+    volatile uint32_t tail;             // next read slot (consumer-owned)
+    uint8_t events[CHIP8_AUDIO_QUEUE_SIZE];
+
+    uint8_t last_state;                 // producer-side edge detector for chip8_audio_update
+    volatile uint8_t shutdown;          // asks the audio thread to exit
+
+    chip8_thread thread;
+
+#if defined(_WIN32)
+    HWAVEOUT device;
+    WAVEHDR headers[CHIP8_AUDIO_NUM_BUFFERS];
+    int16_t samples[CHIP8_AUDIO_NUM_BUFFERS][CHIP8_AUDIO_BUFFER_SAMPLES];
+    uint32_t phase;                     // sample position within the square wave period
+#endif
+};
+
+// Posts one event from the emulation thread. Never blocks: if the ring is full the event is
+// dropped (the next edge re-synchronizes the consumer's notion of the beep state).
+static void chip8_audio_push(chip8_audio_t* audio, chip8_audio_event event) {
+    uint32_t head = audio->head;
+    uint32_t next = (head + 1) % CHIP8_AUDIO_QUEUE_SIZE;
+    if (next == audio->tail) {
+        return;
+    }
+    audio->events[head] = (uint8_t)event;
+    audio->head = next;
+}
+
+// Pops one event on the audio thread. Returns 0 when the ring is empty.
+static chip8_audio_event chip8_audio_pop(chip8_audio_t* audio) {
+    uint32_t tail = audio->tail;
+    if (tail == audio->head) {
+        return (chip8_audio_event)0;
+    }
+    chip8_audio_event event = (chip8_audio_event)audio->events[tail];
+    audio->tail = (tail + 1) % CHIP8_AUDIO_QUEUE_SIZE;
+    return event;
+}
+
+#if defined(_WIN32)
+
+// Opens the waveOut device and queues the initial (silent) buffers. Returns false on failure.
+static bool chip8_audio_backend_open(chip8_audio_t* audio) {
+    WAVEFORMATEX format;
+    memset(&format, 0, sizeof(format));
+    format.wFormatTag = WAVE_FORMAT_PCM;
+    format.nChannels = 1;
+    format.nSamplesPerSec = CHIP8_AUDIO_SAMPLE_RATE;
+    format.wBitsPerSample = 16;
+    format.nBlockAlign = (format.nChannels * format.wBitsPerSample) / 8;
+    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+    if (waveOutOpen(&audio->device, WAVE_MAPPER, &format, 0, 0, CALLBACK_NULL) != MMSYSERR_NOERROR) {
+        return false;
+    }
+
+    for (int i = 0; i < CHIP8_AUDIO_NUM_BUFFERS; i++) {
+        memset(&audio->headers[i], 0, sizeof(WAVEHDR));
+        audio->headers[i].lpData = (LPSTR)audio->samples[i];
+        audio->headers[i].dwBufferLength = sizeof(audio->samples[i]);
+        waveOutPrepareHeader(audio->device, &audio->headers[i], sizeof(WAVEHDR));
+
+        // Mark the buffer as already played so the streaming loop refills it right away
+        audio->headers[i].dwFlags |= WHDR_DONE;
+    }
+    return true;
+}
+
+static void chip8_audio_backend_close(chip8_audio_t* audio) {
+    waveOutReset(audio->device);
+    for (int i = 0; i < CHIP8_AUDIO_NUM_BUFFERS; i++) {
+        waveOutUnprepareHeader(audio->device, &audio->headers[i], sizeof(WAVEHDR));
+    }
+    waveOutClose(audio->device);
+}
+
+// Refills and resubmits every played-out buffer. The device is fed continuously; `playing`
+// selects between the square wave and silence, which makes beep on/off transitions glitch-free
+// (no open/close or reset on the toggle path).
+static void chip8_audio_backend_pump(chip8_audio_t* audio, bool playing) {
+    const uint32_t half_period = CHIP8_AUDIO_SAMPLE_RATE / (2 * CHIP8_AUDIO_TONE_HZ);
+
+    for (int i = 0; i < CHIP8_AUDIO_NUM_BUFFERS; i++) {
+        if (!(audio->headers[i].dwFlags & WHDR_DONE)) {
+            continue;
+        }
+        for (int s = 0; s < CHIP8_AUDIO_BUFFER_SAMPLES; s++) {
+            if (playing) {
+                audio->samples[i][s] = ((audio->phase / half_period) & 1)
+                    ? (int16_t)-CHIP8_AUDIO_AMPLITUDE
+                    : (int16_t)CHIP8_AUDIO_AMPLITUDE;
+                audio->phase = (audio->phase + 1) % (half_period * 2);
+            }
+            else {
+                audio->samples[i][s] = 0;
+            }
+        }
+        audio->headers[i].dwFlags &= ~WHDR_DONE;
+        waveOutWrite(audio->device, &audio->headers[i], sizeof(WAVEHDR));
+    }
+}
+
+#else
+
+// Silent backend: there is no portable audio API without pulling in a dependency, so non-Windows
+// builds run the full queue/thread machinery but produce no sound. Ports replace these three
+// functions with their platform's audio API.
+static bool chip8_audio_backend_open(chip8_audio_t* audio) {
+    (void)audio;
+    return true;
+}
+
+static void chip8_audio_backend_close(chip8_audio_t* audio) {
+    (void)audio;
+}
+
+static void chip8_audio_backend_pump(chip8_audio_t* audio, bool playing) {
+    (void)audio;
+    (void)playing;
+}
+
+#endif
+
+// Audio thread main loop: drain the event ring, keep the device fed, sleep a few milliseconds.
+// The sleep bounds how stale the beep state can get (well under one 60 Hz timer tick).
+static void chip8_audio_main(chip8_audio_t* audio) {
+    bool playing = false;
+
+    while (!audio->shutdown) {
+        chip8_audio_event event;
+        while ((event = chip8_audio_pop(audio)) != 0) {
+            playing = (event == CHIP8_AUDIO_EVENT_START);
+        }
+
+        chip8_audio_backend_pump(audio, playing);
+        chip8_sleep_ms(5);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI chip8_audio_thread_main(LPVOID arg) {
+    chip8_audio_main((chip8_audio_t*)arg);
+    return 0;
+}
+#else
+static void* chip8_audio_thread_main(void* arg) {
+    chip8_audio_main((chip8_audio_t*)arg);
+    return NULL;
+}
+#endif
+
+chip8_audio_t* chip8_audio_init(void) {
+    chip8_audio_t* audio = (chip8_audio_t*)calloc(1, sizeof(chip8_audio_t));
+    if (audio == NULL) {
+        return NULL;
+    }
+
+    if (!chip8_audio_backend_open(audio)) {
+        free(audio);
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    audio->thread = CreateThread(NULL, 0, chip8_audio_thread_main, audio, 0, NULL);
+    if (audio->thread == NULL) {
+        chip8_audio_backend_close(audio);
+        free(audio);
+        return NULL;
+    }
+#else
+    if (pthread_create(&audio->thread, NULL, chip8_audio_thread_main, audio) != 0) {
+        chip8_audio_backend_close(audio);
+        free(audio);
+        return NULL;
+    }
+#endif
+
+    return audio;
+}
+
+void chip8_audio_shutdown(chip8_audio_t* audio) {
+    if (audio == NULL) {
+        return;
+    }
+
+    audio->shutdown = 1;
+#if defined(_WIN32)
+    WaitForSingleObject(audio->thread, INFINITE);
+    CloseHandle(audio->thread);
+#else
+    pthread_join(audio->thread, NULL);
+#endif
+
+    chip8_audio_backend_close(audio);
+    free(audio);
+}
+
+void chip8_audio_update(chip8_audio_t* audio, bool beeping) {
+    if (audio == NULL) {
+        return;
+    }
+
+    uint8_t state = beeping ? 1 : 0;
+    if (state == audio->last_state) {
+        return;
+    }
+    audio->last_state = state;
+    chip8_audio_push(audio, state ? CHIP8_AUDIO_EVENT_START : CHIP8_AUDIO_EVENT_STOP);
+}
@@ -0,0 +1,35 @@
+#ifndef CHIP8_AUDIO_H
+#define CHIP8_AUDIO_H
+
+#include "chip8.h"
+
+/*
+* Audio output for the Chip-8 sound timer.
+*
+* The interpreter itself never does audio I/O: chip8_tick_timers / the Fx18 handler only flip
+* the sound_playing flag in chip8_t (a plain store). The host forwards that flag to
+* chip8_audio_update once per tick, which edge-detects it and posts beep start/stop events into
+* a single-producer single-consumer lock-free ring. A dedicated audio thread consumes the
+* events and generates the square wave, so the emulation thread can never block on sound -
+* unlike the old printf("BEEP!") which stalled the interpreter whenever stdout was a pipe.
+*
+* On Windows the square wave is streamed through waveOut (winmm). On other platforms the
+* module runs the same queue and thread but with a silent backend; ports can drop in their
+* audio API of choice in chip8_audio_backend_*.
+*/
+
+typedef struct chip8_audio chip8_audio_t;
+
+// Starts the audio thread and opens the output device. Returns NULL on failure (the emulator
+// keeps working, just silently).
+chip8_audio_t* chip8_audio_init(void);
+
+// Stops the audio thread and closes the output device.
+void chip8_audio_shutdown(chip8_audio_t* audio);
+
+// Called from the emulation thread (the single producer), typically once per timer tick with
+// chip->sound_playing. Posts a start or stop event only when the state actually changed;
+// costs two loads and at most one store on the emulation thread.
+void chip8_audio_update(chip8_audio_t* audio, bool beeping);
+
+#endif // CHIP8_AUDIO_H
@@ -0,0 +1,272 @@
+// Must precede every system header so pthreads and posix_memalign are visible under -std=c99
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "chip8_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Thin portability layer over Win32 threads / pthreads: a thread handle, one mutex and two
+// condition variables are all the pool needs.
+#if defined(_WIN32)
+
+#include <windows.h>
+
+typedef HANDLE chip8_thread;
+typedef CRITICAL_SECTION chip8_mutex;
+typedef CONDITION_VARIABLE chip8_cond;
+
+#define chip8_mutex_init(m)    InitializeCriticalSection(m)
+#define chip8_mutex_destroy(m) DeleteCriticalSection(m)
+#define chip8_mutex_lock(m)    EnterCriticalSection(m)
+#define chip8_mutex_unlock(m)  LeaveCriticalSection(m)
+#define chip8_cond_init(c)     InitializeConditionVariable(c)
+#define chip8_cond_destroy(c)  ((void)0)
+#define chip8_cond_wait(c, m)  SleepConditionVariableCS(c, m, INFINITE)
+#define chip8_cond_signal(c)   WakeConditionVariable(c)
+#define chip8_cond_broadcast(c) WakeAllConditionVariable(c)
+
+static uint32_t chip8_core_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (uint32_t)info.dwNumberOfProcessors;
+}
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_t chip8_thread;
+typedef pthread_mutex_t chip8_mutex;
+typedef pthread_cond_t chip8_cond;
+
+#define chip8_mutex_init(m)    pthread_mutex_init(m, NULL)
+#define chip8_mutex_destroy(m) pthread_mutex_destroy(m)
+#define chip8_mutex_lock(m)    pthread_mutex_lock(m)
+#define chip8_mutex_unlock(m)  pthread_mutex_unlock(m)
+#define chip8_cond_init(c)     pthread_cond_init(c, NULL)
+#define chip8_cond_destroy(c)  pthread_cond_destroy(c)
+#define chip8_cond_wait(c, m)  pthread_cond_wait(c, m)
+#define chip8_cond_signal(c)   pthread_cond_signal(c)
+#define chip8_cond_broadcast(c) pthread_cond_broadcast(c)
+
+static uint32_t chip8_core_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (uint32_t)n : 1;
+}
+
+#endif
+
+// Cache-line-aligned allocation for the instance array, so instances never share a line
+#define CHIP8_POOL_ALIGN 64
+
+static void* chip8_aligned_alloc(size_t size) {
+#if defined(_WIN32)
+    return _aligned_malloc(size, CHIP8_POOL_ALIGN);
+#else
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, CHIP8_POOL_ALIGN, size) != 0) {
+        return NULL;
+    }
+    return ptr;
+#endif
+}
+
+static void chip8_aligned_free(void* ptr) {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+struct chip8_pool {
+    chip8_t* instances;       // contiguous, cache-line-aligned array of `count` instances
+    uint32_t count;
+
+    chip8_thread* threads;
+    uint32_t thread_count;
+
+    // Tick handshake: chip8_pool_run bumps `generation` and broadcasts; each worker runs its
+    // static slice of the instance array for `cycles` instructions and reports back through
+    // `done_count`. `shutdown` asks the workers to exit.
+    chip8_mutex lock;
+    chip8_cond work_cv;
+    chip8_cond done_cv;
+    uint32_t generation;
+    uint32_t cycles;
+    uint32_t done_count;
+    bool shutdown;
+};
+
+// Per-worker bootstrap argument
+typedef struct {
+    chip8_pool_t* pool;
+    uint32_t index;           // worker index, selects the slice of instances to step
+} chip8_pool_worker_arg;
+
+// Steps this worker's static slice of the instance array for one tick
+static void chip8_pool_work(chip8_pool_t* pool, uint32_t worker_index, uint32_t cycles) {
+    uint32_t begin = (uint32_t)((uint64_t)pool->count * worker_index / pool->thread_count);
+    uint32_t end = (uint32_t)((uint64_t)pool->count * (worker_index + 1) / pool->thread_count);
+
+    for (uint32_t i = begin; i < end; i++) {
+        chip8_run(&pool->instances[i], cycles);
+    }
+}
+
+// Worker main loop: wait for the next generation, run the slice, report done
+static void chip8_pool_worker_main(chip8_pool_worker_arg* arg) {
+    chip8_pool_t* pool = arg->pool;
+    uint32_t worker_index = arg->index;
+    uint32_t seen_generation = 0;
+    free(arg);
+
+    for (;;) {
+        chip8_mutex_lock(&pool->lock);
+        while (pool->generation == seen_generation && !pool->shutdown) {
+            chip8_cond_wait(&pool->work_cv, &pool->lock);
+        }
+        if (pool->shutdown) {
+            chip8_mutex_unlock(&pool->lock);
+            return;
+        }
+        seen_generation = pool->generation;
+        uint32_t cycles = pool->cycles;
+        chip8_mutex_unlock(&pool->lock);
+
+        chip8_pool_work(pool, worker_index, cycles);
+
+        chip8_mutex_lock(&pool->lock);
+        pool->done_count++;
+        chip8_cond_signal(&pool->done_cv);
+        chip8_mutex_unlock(&pool->lock);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI chip8_pool_thread_entry(LPVOID param) {
+    chip8_pool_worker_main((chip8_pool_worker_arg*)param);
+    return 0;
+}
+#else
+static void* chip8_pool_thread_entry(void* param) {
+    chip8_pool_worker_main((chip8_pool_worker_arg*)param);
+    return NULL;
+}
+#endif
+
+chip8_pool_t* chip8_pool_create(uint32_t instance_count, uint32_t thread_count) {
+    if (instance_count == 0) {
+        return NULL;
+    }
+    if (thread_count == 0) {
+        thread_count = chip8_core_count();
+    }
+    // More workers than instances just means idle threads
+    if (thread_count > instance_count) {
+        thread_count = instance_count;
+    }
+
+    chip8_pool_t* pool = calloc(1, sizeof(chip8_pool_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pool->instances = chip8_aligned_alloc(sizeof(chip8_t) * instance_count);
+    pool->threads = calloc(thread_count, sizeof(chip8_thread));
+    if (pool->instances == NULL || pool->threads == NULL) {
+        chip8_aligned_free(pool->instances);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    pool->count = instance_count;
+    pool->thread_count = thread_count;
+    for (uint32_t i = 0; i < instance_count; i++) {
+        chip8_init(&pool->instances[i]);
+    }
+
+    chip8_mutex_init(&pool->lock);
+    chip8_cond_init(&pool->work_cv);
+    chip8_cond_init(&pool->done_cv);
+
+    for (uint32_t i = 0; i < thread_count; i++) {
+        chip8_pool_worker_arg* arg = malloc(sizeof(*arg));
+        if (arg == NULL) {
+            pool->thread_count = i;
+            chip8_pool_destroy(pool);
+            return NULL;
+        }
+        arg->pool = pool;
+        arg->index = i;
+#if defined(_WIN32)
+        pool->threads[i] = CreateThread(NULL, 0, chip8_pool_thread_entry, arg, 0, NULL);
+        if (pool->threads[i] == NULL) {
+#else
+        if (pthread_create(&pool->threads[i], NULL, chip8_pool_thread_entry, arg) != 0) {
+#endif
+            free(arg);
+            pool->thread_count = i;
+            chip8_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void chip8_pool_destroy(chip8_pool_t* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    chip8_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    chip8_cond_broadcast(&pool->work_cv);
+    chip8_mutex_unlock(&pool->lock);
+
+    for (uint32_t i = 0; i < pool->thread_count; i++) {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    chip8_cond_destroy(&pool->done_cv);
+    chip8_cond_destroy(&pool->work_cv);
+    chip8_mutex_destroy(&pool->lock);
+
+    chip8_aligned_free(pool->instances);
+    free(pool->threads);
+    free(pool);
+}
+
+chip8_t* chip8_pool_get(chip8_pool_t* pool, uint32_t index) {
+    if (index >= pool->count) {
+        return NULL;
+    }
+    return &pool->instances[index];
+}
+
+uint32_t chip8_pool_size(const chip8_pool_t* pool) {
+    return pool->count;
+}
+
+void chip8_pool_run(chip8_pool_t* pool, uint32_t cycles) {
+    chip8_mutex_lock(&pool->lock);
+    pool->cycles = cycles;
+    pool->done_count = 0;
+    pool->generation++;
+    chip8_cond_broadcast(&pool->work_cv);
+    while (pool->done_count < pool->thread_count) {
+        chip8_cond_wait(&pool->done_cv, &pool->lock);
+    }
+    chip8_mutex_unlock(&pool->lock);
+}
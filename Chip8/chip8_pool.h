@@ -0,0 +1,48 @@
+#ifndef CHIP8_POOL_H
+#define CHIP8_POOL_H
+
+#include "chip8.h"
+
+/*
+* The chip8_pool owns N emulator instances in one contiguous, cache-line-aligned array and steps
+* all of them in parallel across a set of persistent worker threads. It is the supported way to
+* run many concurrent instances in a single process (tournament services, regression farms)
+* instead of forking one process per game.
+*
+* Usage pattern:
+*   chip8_pool_t* pool = chip8_pool_create(200, 0);   // 0 worker threads = one per core
+*   for each instance i: chip8_load_rom(chip8_pool_get(pool, i), ...);
+*   every tick: chip8_pool_run(pool, cycles);         // steps every instance by `cycles`
+*   at 60 Hz:   chip8_tick_timers per instance (the pool only steps instructions)
+*   input/display handoff happens per instance through chip8_pool_get: call chip8_set_key on an
+*   instance or read its display buffer between ticks, exactly as with a standalone chip8_t.
+*   chip8_pool_destroy(pool);
+*
+* chip8_pool_run blocks until every instance has finished its batch, so between ticks no worker
+* touches the instances and the host may freely inspect or mutate them. All machine state lives
+* inside chip8_t - including the Cxkk random number generator - which is what makes stepping
+* instances on different threads safe.
+*/
+
+typedef struct chip8_pool chip8_pool_t;
+
+// Creates a pool of `instance_count` emulator instances (each initialized with chip8_init) and
+// `thread_count` persistent worker threads; pass 0 to use one worker per processor core.
+// Returns NULL on allocation or thread-creation failure.
+chip8_pool_t* chip8_pool_create(uint32_t instance_count, uint32_t thread_count);
+
+// Stops the worker threads and frees the pool and all of its instances.
+void chip8_pool_destroy(chip8_pool_t* pool);
+
+// Returns instance `index` (0 <= index < chip8_pool_size). The pointer stays valid for the
+// lifetime of the pool. Must not be used while chip8_pool_run is in flight.
+chip8_t* chip8_pool_get(chip8_pool_t* pool, uint32_t index);
+
+// Returns the number of instances in the pool.
+uint32_t chip8_pool_size(const chip8_pool_t* pool);
+
+// Runs every instance in the pool for `cycles` instructions (one chip8_run batch per instance),
+// distributing the instances across the worker threads, and blocks until all are done.
+void chip8_pool_run(chip8_pool_t* pool, uint32_t cycles);
+
+#endif // CHIP8_POOL_H
@@ -0,0 +1,201 @@
+// Must precede every system header so POSIX file mapping is visible under -std=c99
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "chip8_rewind.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Magic number ("CH8R") identifying a rewind ring file
+#define CHIP8_REWIND_MAGIC 0x52384843u
+
+// On-disk layout: this header followed by `capacity` slots of CHIP8_SNAPSHOT_SIZE bytes each.
+// `head` is the slot that receives the next checkpoint and `count` how many slots currently
+// hold one; both live in the mapping itself so a crashed run leaves a readable ring behind.
+typedef struct {
+    uint32_t magic;     // CHIP8_REWIND_MAGIC
+    uint32_t capacity;  // number of snapshot slots in the file
+    uint32_t head;      // slot index that receives the next checkpoint
+    uint32_t count;     // slots currently holding a checkpoint (<= capacity)
+} chip8_rewind_header;
+
+struct chip8_rewind {
+    chip8_rewind_header* map;   // start of the mapping (slots follow the header)
+    size_t map_size;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+// Pointer to slot `index` inside the mapping
+static uint8_t* chip8_rewind_slot(chip8_rewind_t* ring, uint32_t index) {
+    return (uint8_t*)(ring->map + 1) + (size_t)index * CHIP8_SNAPSHOT_SIZE;
+}
+
+static chip8_rewind_t* chip8_rewind_map(const char* path, uint32_t capacity, bool create) {
+    chip8_rewind_t* ring = (chip8_rewind_t*)calloc(1, sizeof(chip8_rewind_t));
+    if (ring == NULL) {
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    ring->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+        create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (ring->file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "rewind: could not %s ring file %s\n", create ? "create" : "open", path);
+        free(ring);
+        return NULL;
+    }
+
+    if (!create) {
+        // Recover the capacity from the existing file's header before sizing the mapping
+        chip8_rewind_header header;
+        DWORD read = 0;
+        if (!ReadFile(ring->file, &header, sizeof(header), &read, NULL) || read != sizeof(header)
+            || header.magic != CHIP8_REWIND_MAGIC || header.capacity == 0) {
+            fprintf(stderr, "rewind: %s is not a rewind ring file\n", path);
+            CloseHandle(ring->file);
+            free(ring);
+            return NULL;
+        }
+        capacity = header.capacity;
+    }
+    ring->map_size = sizeof(chip8_rewind_header) + (size_t)capacity * CHIP8_SNAPSHOT_SIZE;
+
+    ring->mapping = CreateFileMappingA(ring->file, NULL, PAGE_READWRITE,
+        0, (DWORD)ring->map_size, NULL);
+    if (ring->mapping == NULL) {
+        fprintf(stderr, "rewind: could not map ring file %s\n", path);
+        CloseHandle(ring->file);
+        free(ring);
+        return NULL;
+    }
+    ring->map = (chip8_rewind_header*)MapViewOfFile(ring->mapping, FILE_MAP_ALL_ACCESS,
+        0, 0, ring->map_size);
+    if (ring->map == NULL) {
+        fprintf(stderr, "rewind: could not map view of %s\n", path);
+        CloseHandle(ring->mapping);
+        CloseHandle(ring->file);
+        free(ring);
+        return NULL;
+    }
+#else
+    int flags = create ? (O_CREAT | O_TRUNC | O_RDWR) : O_RDWR;
+    int fd = open(path, flags, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "rewind: could not %s ring file %s\n", create ? "create" : "open", path);
+        free(ring);
+        return NULL;
+    }
+
+    if (!create) {
+        // Recover the capacity from the existing file's header before sizing the mapping
+        chip8_rewind_header header;
+        if (read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)
+            || header.magic != CHIP8_REWIND_MAGIC || header.capacity == 0) {
+            fprintf(stderr, "rewind: %s is not a rewind ring file\n", path);
+            close(fd);
+            free(ring);
+            return NULL;
+        }
+        capacity = header.capacity;
+    }
+    ring->map_size = sizeof(chip8_rewind_header) + (size_t)capacity * CHIP8_SNAPSHOT_SIZE;
+
+    if (create && ftruncate(fd, (off_t)ring->map_size) != 0) {
+        fprintf(stderr, "rewind: could not size ring file %s\n", path);
+        close(fd);
+        free(ring);
+        return NULL;
+    }
+    ring->map = (chip8_rewind_header*)mmap(NULL, ring->map_size,
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring->map == MAP_FAILED) {
+        fprintf(stderr, "rewind: could not map ring file %s\n", path);
+        free(ring);
+        return NULL;
+    }
+#endif
+
+    if (create) {
+        ring->map->magic = CHIP8_REWIND_MAGIC;
+        ring->map->capacity = capacity;
+        ring->map->head = 0;
+        ring->map->count = 0;
+    }
+    return ring;
+}
+
+chip8_rewind_t* chip8_rewind_create(const char* path, uint32_t capacity) {
+    if (capacity == 0) {
+        return NULL;
+    }
+    return chip8_rewind_map(path, capacity, true);
+}
+
+chip8_rewind_t* chip8_rewind_open(const char* path) {
+    return chip8_rewind_map(path, 0, false);
+}
+
+void chip8_rewind_close(chip8_rewind_t* ring) {
+    if (ring == NULL) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(ring->map);
+    CloseHandle(ring->mapping);
+    CloseHandle(ring->file);
+#else
+    munmap(ring->map, ring->map_size);
+#endif
+    free(ring);
+}
+
+void chip8_rewind_checkpoint(chip8_rewind_t* ring, const chip8_t* chip) {
+    chip8_rewind_header* header = ring->map;
+
+    // The snapshot memcpy goes straight into the mapping; the OS flushes the dirty pages
+    // whenever it likes, so there is no explicit I/O on this path
+    chip8_snapshot(chip, chip8_rewind_slot(ring, header->head));
+
+    header->head = (header->head + 1) % header->capacity;
+    if (header->count < header->capacity) {
+        header->count++;
+    }
+}
+
+uint32_t chip8_rewind_count(const chip8_rewind_t* ring) {
+    return ring->map->count;
+}
+
+bool chip8_rewind_restore(chip8_rewind_t* ring, chip8_t* chip, uint32_t back) {
+    chip8_rewind_header* header = ring->map;
+    if (back >= header->count) {
+        return false;
+    }
+
+    // head is one past the newest checkpoint; walk back + 1 slots from it (mod capacity)
+    uint32_t index = (header->head + header->capacity - 1 - back) % header->capacity;
+    if (!chip8_restore(chip, chip8_rewind_slot(ring, index))) {
+        return false;
+    }
+
+    // Drop the checkpoints newer than the restored one: the next checkpoint overwrites the
+    // abandoned future, and another restore with the same `back` steps further into the past
+    header->head = (index + 1) % header->capacity;
+    header->count -= back;
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef CHIP8_REWIND_H
+#define CHIP8_REWIND_H
+
+#include "chip8.h"
+
+/*
+* Continuous checkpointing ("rewind ring") for a chip8_t instance.
+*
+* The ring is a memory-mapped file holding the last `capacity` snapshots of the machine.
+* Checkpointing is one chip8_snapshot into the mapping - a memcpy of a flat ~7 KB struct -
+* and the OS writes dirty pages back lazily, so a host checkpointing every few frames pays no
+* steady-state I/O. Once the ring is full the oldest checkpoint is overwritten; 1024 slots is
+* well under 8 MB of file.
+*
+* chip8_rewind_restore jumps the machine back to any retained checkpoint instantly and drops
+* the checkpoints newer than it, so stepping backwards repeatedly walks further into the past
+* - crash triage on a misbehaving ROM becomes "rewind a few steps and dump the trace ring"
+* instead of re-running from the start with prints.
+*
+* Because the mapping is file-backed, the ring survives a host crash: chip8_rewind_open maps
+* an existing ring file read-write so a post-mortem tool can restore its checkpoints into a
+* fresh instance. Slots hold ordinary versioned snapshots, so an incompatible build rejects
+* them the same way chip8_restore always does.
+*/
+
+typedef struct chip8_rewind chip8_rewind_t;
+
+// Creates (or truncates) the ring file at `path` with room for `capacity` checkpoints and
+// maps it. Returns NULL if the file cannot be created, sized or mapped.
+chip8_rewind_t* chip8_rewind_create(const char* path, uint32_t capacity);
+
+// Maps an existing ring file, keeping the checkpoints it already holds (e.g. from a crashed
+// run). Returns NULL if the file is missing, malformed or cannot be mapped.
+chip8_rewind_t* chip8_rewind_open(const char* path);
+
+// Unmaps and closes the ring. The file and its checkpoints remain on disk.
+void chip8_rewind_close(chip8_rewind_t* ring);
+
+// Appends a checkpoint of the machine's current state, overwriting the oldest one once the
+// ring is full. Call it on whatever cadence suits the host (every M frames); the cost is the
+// snapshot memcpy, nothing more.
+void chip8_rewind_checkpoint(chip8_rewind_t* ring, const chip8_t* chip);
+
+// Returns how many checkpoints the ring currently retains (0 .. capacity).
+uint32_t chip8_rewind_count(const chip8_rewind_t* ring);
+
+// Restores the checkpoint taken `back` checkpoints ago (0 = the most recent) into `chip` and
+// drops every checkpoint newer than it, so the ring's timeline matches the machine's again.
+// Returns false (leaving `chip` untouched) if `back` reaches past what the ring retains or
+// the slot was written by an incompatible build.
+bool chip8_rewind_restore(chip8_rewind_t* ring, chip8_t* chip, uint32_t back);
+
+#endif // CHIP8_REWIND_H
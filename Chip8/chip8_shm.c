@@ -0,0 +1,201 @@
+// Must precede every system header so POSIX shared memory is visible under -std=c99
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "chip8_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Full memory barrier separating the seqlock counter updates from the payload copy. The
+// volatile counter alone stops the compiler from reordering; this also stops the CPU.
+#if defined(_WIN32)
+#define chip8_shm_barrier() MemoryBarrier()
+#else
+#define chip8_shm_barrier() __sync_synchronize()
+#endif
+
+// What actually lives in the shared segment. `seq` is even between publishes and odd while
+// one is in progress; `frame` counts publishes so viewers can skip unchanged frames.
+typedef struct {
+    volatile uint32_t seq;
+    uint32_t color_mode;
+    uint64_t frame;
+    uint8_t display[CHIP8_DISPLAY_BUFFER_SIZE];
+} chip8_shm_frame;
+
+struct chip8_shm {
+    chip8_shm_frame* map;
+    bool creator;
+#if defined(_WIN32)
+    HANDLE mapping;
+#else
+    char name[64];
+#endif
+};
+
+// Builds the platform's segment name from the caller's plain name
+#if defined(_WIN32)
+static void chip8_shm_name(char* out, size_t out_size, const char* name) {
+    _snprintf_s(out, out_size, _TRUNCATE, "Local\\%s", name);
+}
+#else
+static void chip8_shm_name(char* out, size_t out_size, const char* name) {
+    snprintf(out, out_size, "/%s", name);
+}
+#endif
+
+static chip8_shm_t* chip8_shm_map(const char* name, bool create) {
+    chip8_shm_t* shm = (chip8_shm_t*)calloc(1, sizeof(chip8_shm_t));
+    if (shm == NULL) {
+        return NULL;
+    }
+    shm->creator = create;
+
+    char sys_name[64];
+    chip8_shm_name(sys_name, sizeof(sys_name), name);
+
+#if defined(_WIN32)
+    if (create) {
+        shm->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+            0, (DWORD)sizeof(chip8_shm_frame), sys_name);
+    }
+    else {
+        shm->mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, sys_name);
+    }
+    if (shm->mapping == NULL) {
+        fprintf(stderr, "shm: could not %s mapping %s\n", create ? "create" : "open", sys_name);
+        free(shm);
+        return NULL;
+    }
+
+    shm->map = (chip8_shm_frame*)MapViewOfFile(shm->mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(chip8_shm_frame));
+    if (shm->map == NULL) {
+        fprintf(stderr, "shm: could not map view of %s\n", sys_name);
+        CloseHandle(shm->mapping);
+        free(shm);
+        return NULL;
+    }
+#else
+    snprintf(shm->name, sizeof(shm->name), "%s", sys_name);
+
+    int flags = create ? (O_CREAT | O_RDWR) : O_RDWR;
+    int fd = shm_open(sys_name, flags, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "shm: could not %s segment %s\n", create ? "create" : "open", sys_name);
+        free(shm);
+        return NULL;
+    }
+    if (create && ftruncate(fd, (off_t)sizeof(chip8_shm_frame)) != 0) {
+        fprintf(stderr, "shm: could not size segment %s\n", sys_name);
+        close(fd);
+        shm_unlink(sys_name);
+        free(shm);
+        return NULL;
+    }
+
+    shm->map = (chip8_shm_frame*)mmap(NULL, sizeof(chip8_shm_frame),
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm->map == MAP_FAILED) {
+        fprintf(stderr, "shm: could not map segment %s\n", sys_name);
+        if (create) {
+            shm_unlink(sys_name);
+        }
+        free(shm);
+        return NULL;
+    }
+#endif
+
+    if (create) {
+        memset(shm->map, 0, sizeof(chip8_shm_frame));
+    }
+    return shm;
+}
+
+chip8_shm_t* chip8_shm_create(const char* name) {
+    return chip8_shm_map(name, true);
+}
+
+chip8_shm_t* chip8_shm_open(const char* name) {
+    return chip8_shm_map(name, false);
+}
+
+void chip8_shm_close(chip8_shm_t* shm) {
+    if (shm == NULL) {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile((void*)shm->map);
+    CloseHandle(shm->mapping);
+#else
+    munmap((void*)shm->map, sizeof(chip8_shm_frame));
+    if (shm->creator) {
+        shm_unlink(shm->name);
+    }
+#endif
+    free(shm);
+}
+
+void chip8_shm_publish(chip8_shm_t* shm, chip8_t* chip) {
+    chip8_shm_frame* frame = shm->map;
+
+    // Monochrome instances draw into the packed buffer; expand it so viewers always get the
+    // byte-per-pixel format
+    if (!chip->colorMode) {
+        chip8_display_unpack(chip);
+    }
+
+    // Seqlock write: odd while the payload is inconsistent, even when it is safe to read
+    frame->seq++;
+    chip8_shm_barrier();
+
+    memcpy(frame->display, chip->display, sizeof(frame->display));
+    frame->color_mode = chip->colorMode;
+    frame->frame++;
+
+    chip8_shm_barrier();
+    frame->seq++;
+}
+
+bool chip8_shm_read(chip8_shm_t* shm, uint8_t* display, uint8_t* color_mode, uint64_t* frame) {
+    chip8_shm_frame* map = shm->map;
+
+    for (;;) {
+        uint32_t seq = map->seq;
+        if (seq & 1) {
+            // A publish is in flight; it finishes within a 2 KB memcpy, so just spin
+            continue;
+        }
+
+        chip8_shm_barrier();
+        uint64_t published = map->frame;
+        if (published == 0) {
+            return false;
+        }
+        memcpy(display, (const uint8_t*)map->display, CHIP8_DISPLAY_BUFFER_SIZE);
+        uint8_t mode = (uint8_t)map->color_mode;
+        chip8_shm_barrier();
+
+        if (map->seq == seq) {
+            // No publish raced our copy: the frame is consistent
+            if (color_mode != NULL) {
+                *color_mode = mode;
+            }
+            if (frame != NULL) {
+                *frame = published;
+            }
+            return true;
+        }
+    }
+}
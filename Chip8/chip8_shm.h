@@ -0,0 +1,43 @@
+#ifndef CHIP8_SHM_H
+#define CHIP8_SHM_H
+
+#include "chip8.h"
+
+/*
+* Shared-memory display export for out-of-process frontends.
+*
+* The emulating process creates a named shared-memory segment and publishes the display buffer
+* into it once per frame; viewer processes (dashboards, stream encoders) open the same name and
+* poll frames with no pipe, socket or copy chain in between. Synchronization is a seqlock: the
+* publisher bumps a sequence counter to an odd value, copies the 2048-byte display, and bumps
+* it even again. A reader that sees an odd value or a changed value across its copy simply
+* retries - the publisher never waits, so display export can never stall the emulation thread,
+* and at 2 KB per frame a torn read costs a microsecond to retry.
+*
+* Windows uses a named file mapping (Local\<name>), other platforms POSIX shm_open (/<name>).
+*/
+
+typedef struct chip8_shm chip8_shm_t;
+
+// Creates (or replaces) the named segment and maps it for publishing.
+// Returns NULL on failure.
+chip8_shm_t* chip8_shm_create(const char* name);
+
+// Opens an existing segment created by another process for reading.
+// Returns NULL if it does not exist.
+chip8_shm_t* chip8_shm_open(const char* name);
+
+// Unmaps the segment; the creator also unlinks the name where the platform requires it.
+void chip8_shm_close(chip8_shm_t* shm);
+
+// Publishes the current display into the segment (seqlock write; never blocks). For
+// monochrome instances the packed display64 buffer is expanded via chip8_display_unpack, so
+// viewers always see the byte-per-pixel format regardless of color mode.
+void chip8_shm_publish(chip8_shm_t* shm, chip8_t* chip);
+
+// Copies the most recently published frame into `display` (CHIP8_DISPLAY_BUFFER_SIZE bytes).
+// `color_mode` and `frame` (publish counter, monotonically increasing) may be NULL. Returns
+// false if nothing has been published yet.
+bool chip8_shm_read(chip8_shm_t* shm, uint8_t* display, uint8_t* color_mode, uint64_t* frame);
+
+#endif // CHIP8_SHM_H
@@ -0,0 +1,238 @@
+#include "chip8_tape.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// One logged input event, stamped with the instruction count it occurred at. Timer ticks are
+// ordinary events (key/state unused) so replay delivers them at the recorded cycle instead of
+// at the replaying machine's wall clock.
+typedef enum {
+    CHIP8_TAPE_EVENT_KEY = 1,
+    CHIP8_TAPE_EVENT_TIMER = 2
+} chip8_tape_event_type;
+
+typedef struct {
+    uint64_t cycle;     // chip->cycles when the event was recorded
+    uint8_t type;       // chip8_tape_event_type
+    uint8_t key;        // chip8_key (key events only)
+    uint8_t state;      // 1 = pressed, 0 = released (key events only)
+} chip8_tape_event;
+
+// Magic number ("CH8T") and version of the tape file format. The embedded snapshot carries
+// its own version, so this only needs bumping when the tape layout itself changes.
+#define CHIP8_TAPE_MAGIC 0x54384843u
+#define CHIP8_TAPE_VERSION 1
+
+struct chip8_tape {
+    uint8_t start[CHIP8_SNAPSHOT_SIZE]; // machine state at chip8_tape_record_begin
+    uint64_t end_cycle;                 // chip->cycles at chip8_tape_record_end; replay stops here
+    chip8_tape_event* events;           // growable append-only log
+    size_t count;
+    size_t capacity;
+    size_t cursor;                      // next event to deliver during replay
+    bool recording;
+};
+
+chip8_tape_t* chip8_tape_create(void) {
+    return (chip8_tape_t*)calloc(1, sizeof(chip8_tape_t));
+}
+
+void chip8_tape_destroy(chip8_tape_t* tape) {
+    if (tape == NULL) {
+        return;
+    }
+    free(tape->events);
+    free(tape);
+}
+
+// Appends one event, growing the log by doubling. On allocation failure the event is dropped
+// and recording stops, leaving a truncated but internally consistent tape.
+static void chip8_tape_append(chip8_tape_t* tape, uint64_t cycle, uint8_t type, uint8_t key, uint8_t state) {
+    if (tape->count == tape->capacity) {
+        size_t new_capacity = (tape->capacity == 0) ? 256 : tape->capacity * 2;
+        chip8_tape_event* events = (chip8_tape_event*)realloc(tape->events, new_capacity * sizeof(chip8_tape_event));
+        if (events == NULL) {
+            fprintf(stderr, "tape: out of memory, recording stopped at %u events\n", (unsigned)tape->count);
+            tape->recording = false;
+            return;
+        }
+        tape->events = events;
+        tape->capacity = new_capacity;
+    }
+
+    chip8_tape_event* event = &tape->events[tape->count++];
+    event->cycle = cycle;
+    event->type = type;
+    event->key = key;
+    event->state = state;
+}
+
+void chip8_tape_record_begin(chip8_tape_t* tape, const chip8_t* chip) {
+    tape->count = 0;
+    tape->cursor = 0;
+    tape->end_cycle = 0;
+    tape->recording = true;
+    chip8_snapshot(chip, tape->start);
+}
+
+void chip8_tape_record_end(chip8_tape_t* tape, const chip8_t* chip) {
+    tape->recording = false;
+    // Replay stops exactly here, so a replayed machine ends in the recorded end state instead
+    // of running on past the last event
+    tape->end_cycle = chip->cycles;
+}
+
+void chip8_tape_key(chip8_tape_t* tape, chip8_t* chip, chip8_key key, uint8_t state) {
+    if (tape != NULL && tape->recording) {
+        chip8_tape_append(tape, chip->cycles, CHIP8_TAPE_EVENT_KEY, (uint8_t)key, state);
+    }
+    chip8_set_key(chip, key, state);
+}
+
+void chip8_tape_tick_timers(chip8_tape_t* tape, chip8_t* chip) {
+    if (tape != NULL && tape->recording) {
+        chip8_tape_append(tape, chip->cycles, CHIP8_TAPE_EVENT_TIMER, 0, 0);
+    }
+    chip8_tick_timers(chip);
+}
+
+bool chip8_tape_replay_begin(chip8_tape_t* tape, chip8_t* chip) {
+    tape->recording = false;
+    tape->cursor = 0;
+    return chip8_restore(chip, tape->start);
+}
+
+uint32_t chip8_tape_replay_run(chip8_tape_t* tape, chip8_t* chip, uint32_t cycles) {
+    uint32_t executed = 0;
+
+    while (executed < cycles) {
+        // Deliver every event recorded at the current instruction count before running on
+        while (tape->cursor < tape->count && tape->events[tape->cursor].cycle == chip->cycles) {
+            chip8_tape_event* event = &tape->events[tape->cursor++];
+            if (event->type == CHIP8_TAPE_EVENT_KEY) {
+                chip8_set_key(chip, (chip8_key)event->key, event->state);
+            }
+            else {
+                chip8_tick_timers(chip);
+            }
+        }
+
+        // Run up to the next event, or to the recorded end of the session once the event log
+        // is exhausted
+        uint32_t budget = cycles - executed;
+        uint64_t stop = (tape->cursor < tape->count) ? tape->events[tape->cursor].cycle : tape->end_cycle;
+        if (stop <= chip->cycles) {
+            break;
+        }
+        if (stop - chip->cycles < budget) {
+            budget = (uint32_t)(stop - chip->cycles);
+        }
+        uint64_t before = chip->cycles;
+        chip8_run(chip, budget);
+        uint32_t ran = (uint32_t)(chip->cycles - before);
+        executed += ran;
+
+        // The core stopped (parked idle, Fx0A key-wait, or a fault) before reaching the next
+        // event's cycle. On a faithful replay a parked core never has future-stamped events -
+        // everything recorded while it was parked carries the frozen instruction count and was
+        // delivered above - so there is nothing left to make progress with.
+        if (ran < budget) {
+            break;
+        }
+    }
+
+    return executed;
+}
+
+bool chip8_tape_at_end(const chip8_tape_t* tape) {
+    return tape->cursor >= tape->count;
+}
+
+bool chip8_tape_replay_done(const chip8_tape_t* tape, const chip8_t* chip) {
+    return tape->cursor >= tape->count && chip->cycles >= tape->end_cycle;
+}
+
+size_t chip8_tape_event_count(const chip8_tape_t* tape) {
+    return tape->count;
+}
+
+bool chip8_tape_save(const chip8_tape_t* tape, const char* filename) {
+    FILE* file;
+#if defined(_MSC_VER) || defined(__STDC_LIB_EXT1__)
+    if (fopen_s(&file, filename, "wb") != 0) {
+        file = NULL;
+    }
+#else
+    file = fopen(filename, "wb");
+#endif
+    if (file == NULL) {
+        fprintf(stderr, "tape: could not open %s for writing\n", filename);
+        return false;
+    }
+
+    uint32_t magic = CHIP8_TAPE_MAGIC;
+    uint32_t version = CHIP8_TAPE_VERSION;
+    uint64_t count = (uint64_t)tape->count;
+
+    bool ok = fwrite(&magic, sizeof(magic), 1, file) == 1
+        && fwrite(&version, sizeof(version), 1, file) == 1
+        && fwrite(&count, sizeof(count), 1, file) == 1
+        && fwrite(&tape->end_cycle, sizeof(tape->end_cycle), 1, file) == 1
+        && fwrite(tape->start, sizeof(tape->start), 1, file) == 1
+        && (tape->count == 0 || fwrite(tape->events, sizeof(chip8_tape_event), tape->count, file) == tape->count);
+
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "tape: short write to %s\n", filename);
+    }
+    return ok;
+}
+
+chip8_tape_t* chip8_tape_load(const char* filename) {
+    FILE* file;
+#if defined(_MSC_VER) || defined(__STDC_LIB_EXT1__)
+    if (fopen_s(&file, filename, "rb") != 0) {
+        file = NULL;
+    }
+#else
+    file = fopen(filename, "rb");
+#endif
+    if (file == NULL) {
+        fprintf(stderr, "tape: could not open %s\n", filename);
+        return NULL;
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t count = 0;
+    if (fread(&magic, sizeof(magic), 1, file) != 1
+        || fread(&version, sizeof(version), 1, file) != 1
+        || fread(&count, sizeof(count), 1, file) != 1
+        || magic != CHIP8_TAPE_MAGIC || version != CHIP8_TAPE_VERSION) {
+        fprintf(stderr, "tape: %s is not a compatible tape file\n", filename);
+        fclose(file);
+        return NULL;
+    }
+
+    chip8_tape_t* tape = chip8_tape_create();
+    if (tape == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    tape->events = (count > 0) ? (chip8_tape_event*)malloc((size_t)count * sizeof(chip8_tape_event)) : NULL;
+    if ((count > 0 && tape->events == NULL)
+        || fread(&tape->end_cycle, sizeof(tape->end_cycle), 1, file) != 1
+        || fread(tape->start, sizeof(tape->start), 1, file) != 1
+        || (count > 0 && fread(tape->events, sizeof(chip8_tape_event), (size_t)count, file) != (size_t)count)) {
+        fprintf(stderr, "tape: short read from %s\n", filename);
+        fclose(file);
+        chip8_tape_destroy(tape);
+        return NULL;
+    }
+
+    tape->count = (size_t)count;
+    tape->capacity = (size_t)count;
+    fclose(file);
+    return tape;
+}
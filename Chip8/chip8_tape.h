@@ -0,0 +1,81 @@
+#ifndef CHIP8_TAPE_H
+#define CHIP8_TAPE_H
+
+#include "chip8.h"
+
+/*
+* Deterministic record/replay ("tape") for a chip8_t instance.
+*
+* The interpreter is fully deterministic: given the same start state, the same PRNG state and
+* the same key/timer events at the same instruction counts, it reproduces a run bit for bit.
+* A tape captures exactly those inputs - a start snapshot plus a compact append-only log of
+* {cycle, event} records - so a multi-minute interactive session compresses to a few dozen KB
+* and can be replayed headless at fast-forward speed.
+*
+* Recording: the host routes its input through the tape instead of calling the core directly -
+* chip8_tape_key in place of chip8_set_key, chip8_tape_tick_timers in place of
+* chip8_tick_timers. Both forward to the core and append a record stamped with chip->cycles.
+* Timer ticks are recorded because the host schedules them from the wall clock; replay must
+* deliver them at the same instruction counts, not at the replaying machine's wall clock.
+*
+* Replay: chip8_tape_replay_begin restores the recorded start snapshot, then
+* chip8_tape_replay_run alternates chip8_run segments with event delivery so every event
+* lands at exactly the instruction count it was recorded at. Run it in a loop until
+* chip8_tape_at_end and the machine finishes in the recorded end state.
+*
+* Tapes saved with chip8_tape_save embed the snapshot, so a loaded tape replays on a fresh
+* instance with no ROM file present; like snapshots they are rejected by incompatible builds.
+*/
+
+typedef struct chip8_tape chip8_tape_t;
+
+// Creates an empty tape. Returns NULL on allocation failure.
+chip8_tape_t* chip8_tape_create(void);
+
+// Frees the tape and its event log.
+void chip8_tape_destroy(chip8_tape_t* tape);
+
+// Starts recording: clears the event log and captures the machine's current state as the
+// replay starting point. Call it once, then route all input through chip8_tape_key and
+// chip8_tape_tick_timers while the session runs.
+void chip8_tape_record_begin(chip8_tape_t* tape, const chip8_t* chip);
+
+// Forwards a key event to chip8_set_key and, while recording, appends it to the tape.
+// A NULL tape just forwards, so hosts can keep one call site for both modes.
+void chip8_tape_key(chip8_tape_t* tape, chip8_t* chip, chip8_key key, uint8_t state);
+
+// Forwards a 60 Hz tick to chip8_tick_timers and, while recording, appends it to the tape.
+// A NULL tape just forwards.
+void chip8_tape_tick_timers(chip8_tape_t* tape, chip8_t* chip);
+
+// Stops appending to the tape and records the session's final instruction count, which is
+// where replay stops (so a replayed machine finishes in exactly the recorded end state).
+void chip8_tape_record_end(chip8_tape_t* tape, const chip8_t* chip);
+
+// Starts replay: restores the recorded start snapshot into `chip` and rewinds the event
+// cursor. Returns false if the snapshot was taken by an incompatible build.
+bool chip8_tape_replay_begin(chip8_tape_t* tape, chip8_t* chip);
+
+// Replays up to `cycles` instructions, delivering each recorded event at exactly the
+// instruction count it was recorded at. Returns the number of instructions executed (which
+// can be less than requested when the core parks idle between events or the tape runs out).
+uint32_t chip8_tape_replay_run(chip8_tape_t* tape, chip8_t* chip, uint32_t cycles);
+
+// Returns true once every recorded event has been delivered during replay.
+bool chip8_tape_at_end(const chip8_tape_t* tape);
+
+// Returns true once the replay has both delivered every event and reached the recorded final
+// instruction count - i.e. `chip` is in the recorded end state.
+bool chip8_tape_replay_done(const chip8_tape_t* tape, const chip8_t* chip);
+
+// Returns the number of recorded events.
+size_t chip8_tape_event_count(const chip8_tape_t* tape);
+
+// Writes the tape (start snapshot + event log) to a file. Returns false on I/O failure.
+bool chip8_tape_save(const chip8_tape_t* tape, const char* filename);
+
+// Reads a tape previously written by chip8_tape_save. Returns NULL if the file cannot be
+// read or was written by an incompatible build.
+chip8_tape_t* chip8_tape_load(const char* filename);
+
+#endif // CHIP8_TAPE_H
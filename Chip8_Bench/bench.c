@@ -0,0 +1,190 @@
+// Headless interpreter benchmark.
+//
+// Runs a ROM for a fixed wall-clock budget without any windowing or OpenGL (the Chip8 core is
+// the only dependency) and reports executed instructions per second, how the executed
+// instructions break down per opcode family, and how much of the wall time was spent inside
+// chip8_DRW_Vx_Vy_nibble. This is the gate for every performance change to the interpreter:
+// run it on the same ROM before and after and compare the instructions/second line.
+//
+// Usage: Chip8_Bench [rom] [seconds]
+//   rom      path to a .ch8 file           (default: ../Games/Space_Invaders.ch8)
+//   seconds  wall-clock budget in seconds  (default: 5)
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "chip8.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+
+// Returns a monotonic wall-clock timestamp in nanoseconds
+static uint64_t bench_now_ns(void) {
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart * 1000000000ull / (uint64_t)freq.QuadPart);
+}
+#else
+#include <time.h>
+
+// Returns a monotonic wall-clock timestamp in nanoseconds
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+// How many instructions to execute between wall-clock checks, so the clock reads themselves
+// don't show up in the measurement
+#define BENCH_SLICE 4096
+
+// Human-readable names for the 16 opcode families (indexed by the opcode's high nibble)
+static const char* family_names[16] = {
+    "0nnn SYS/CLS/RET", "1nnn JP",   "2nnn CALL", "3xkk SE",
+    "4xkk SNE",         "5xy0 SE",   "6xkk LD",   "7xkk ADD",
+    "8xyN ALU",         "9xy0 SNE",  "Annn LD I", "Bnnn JP V0",
+    "Cxkk RND",         "Dxyn DRW",  "Ex9E/A1 SKP", "FxXX misc"
+};
+
+int main(int argc, char** argv) {
+    const char* rom = (argc > 1) ? argv[1] : "../Games/Space_Invaders.ch8";
+    double seconds = (argc > 2) ? atof(argv[2]) : 5.0;
+
+    chip8_t chip;
+    chip8_init(&chip);
+
+    if (!chip8_load_rom(&chip, rom)) {
+        return 1;
+    }
+
+    // Decode each program address once instead of per execution
+    chip8_dcache_enable(&chip, true);
+
+    // Collect the per-family tick histogram alongside our own counters
+    chip8_profile_enable(&chip, true);
+
+    uint64_t family_counts[16];
+    memset(family_counts, 0, sizeof(family_counts));
+
+    uint64_t total_instructions = 0;
+    uint64_t drw_ns = 0;
+    uint64_t slices = 0;
+    uint64_t stalled_slices = 0;
+
+    uint64_t start_ns = bench_now_ns();
+    uint64_t deadline_ns = start_ns + (uint64_t)(seconds * 1e9);
+
+    while (bench_now_ns() < deadline_ns) {
+        // Stub keypad input: toggle one key per slice so ROMs that sit on Fx0A (or poll
+        // Ex9E/ExA1, like Space Invaders' start screen) keep making progress.
+        chip8_key key = (chip8_key)(slices % 16);
+        chip8_set_key(&chip, key, (slices & 1) ? 1 : 0);
+        slices++;
+
+        uint64_t executed_this_slice = 0;
+
+        for (int i = 0; i < BENCH_SLICE; i++) {
+            if (chip.pc >= CHIP8_MEM_SIZE - 1) {
+                fprintf(stderr, "Stopping: program counter out of bounds at 0x%04X\n", chip.pc);
+                goto report;
+            }
+
+            // Peek at the opcode to classify it before executing it
+            uint16_t opcode = (chip.mem[chip.pc] << 8) | chip.mem[chip.pc + 1];
+            int family = opcode >> 12;
+
+            // A parked core (Fx0A key-wait or a detected spin loop) or a faulted one makes
+            // chip8_step a no-op, so what actually executed is the cycle counter delta -
+            // never the number of times this loop spun. Counting iterations here used to
+            // report hundreds of millions of "instructions" per second that were 100%
+            // parked jump-to-self no-ops.
+            uint64_t cycles_before = chip.cycles;
+            chip8_status status;
+
+            if (family == 0xD) {
+                // Time the draw handler separately; it dominates most game profiles
+                uint64_t t0 = bench_now_ns();
+                status = chip8_step(&chip);
+                uint64_t dt = bench_now_ns() - t0;
+                if (chip.cycles != cycles_before) {
+                    drw_ns += dt;
+                }
+            }
+            else {
+                status = chip8_step(&chip);
+            }
+
+            if (status != CHIP8_OK) {
+                fprintf(stderr, "Stopping: core faulted with status %d at 0x%04X (opcode 0x%04X)\n",
+                    (int)status, chip.fault_pc, chip.fault_opcode);
+                goto report;
+            }
+            if (chip.cycles == cycles_before) {
+                // Parked: leave the slice so the next key/timer event can wake the core
+                // instead of spinning through uncounted no-op steps
+                break;
+            }
+
+            family_counts[family]++;
+            total_instructions++;
+            executed_this_slice++;
+
+            // Tick the 60 Hz timers once per emulated frame worth of instructions, so
+            // delay-timer-driven game logic keeps progressing at the usual in-game pace
+            if (total_instructions % CHIP8_CYCLES_PER_FRAME == 0) {
+                chip8_tick_timers(&chip);
+            }
+        }
+
+        // A ROM that re-parks after at most a couple of instructions per wake (one for the
+        // key event, possibly one more for the timer tick) through a whole key press/release
+        // cycle (32 slices) has reached its halt loop - the classic jump-to-self
+        // end-of-program pattern. A genuine delay-timer wait executes its full
+        // Fx07/skip/jump round per wake and so never trips this; running out the clock on a
+        // halted ROM would only measure park/wake churn.
+        if (executed_this_slice <= 2 && (chip.idle || chip.waiting_key)) {
+            if (++stalled_slices >= 32) {
+                fprintf(stderr, "Stopping: core re-parks on every wake (program has halted)\n");
+                goto report;
+            }
+        }
+        else {
+            stalled_slices = 0;
+        }
+    }
+
+report:;
+    uint64_t elapsed_ns = bench_now_ns() - start_ns;
+    double elapsed_s = (double)elapsed_ns / 1e9;
+    double ips = (elapsed_s > 0.0) ? (double)total_instructions / elapsed_s : 0.0;
+
+    printf("rom:                 %s\n", rom);
+    printf("wall time:           %.3f s\n", elapsed_s);
+    printf("instructions:        %llu\n", (unsigned long long)total_instructions);
+    printf("instructions/second: %.0f\n", ips);
+    printf("time in Dxyn DRW:    %.3f s (%.1f%% of wall time)\n",
+        (double)drw_ns / 1e9, elapsed_ns ? 100.0 * (double)drw_ns / (double)elapsed_ns : 0.0);
+    printf("\nper-family counts:\n");
+    for (int i = 0; i < 16; i++) {
+        if (family_counts[i] == 0) {
+            continue;
+        }
+        printf("  %-16s %12llu (%5.1f%%)\n", family_names[i],
+            (unsigned long long)family_counts[i],
+            total_instructions ? 100.0 * (double)family_counts[i] / (double)total_instructions : 0.0);
+    }
+
+    printf("\nhandler tick profile:\n");
+    chip8_profile_report(&chip, stdout);
+
+    return 0;
+}
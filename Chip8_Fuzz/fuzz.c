@@ -0,0 +1,324 @@
+// Coverage-guided interpreter fuzzer.
+//
+// Drives the core directly on in-memory programs instead of spawning the GUI build per case:
+// every case is a chip8_reset_from against a pristine golden instance (which copies back only
+// the memory granules the previous case dirtied), a load via chip8_load_rom_from_memory, and
+// a bounded number of chip8_step calls - no process, no file, no rendering. A machine in the
+// millions-of-cases-per-hour range follows from that alone.
+//
+// Coverage is a 64-bit mask with one bit per implemented instruction (the opcode is
+// classified by a table mirroring the dispatch layout, one peek per step). A mutated program
+// that lights up a coverage bit no earlier case reached is added to the corpus, and new cases
+// are mutations of random corpus entries - so the corpus grows toward programs that execute
+// rare handlers instead of dying on byte 0.
+//
+// The harness also probes the interpreter's known hazard edges before each step - CALL with a
+// full stack, RET with an empty one, and I running past the end of memory under DRW/Fx33/
+// Fx55/Fx65 (which would write outside `mem`) - counting each hit and ending the case instead
+// of letting the struct get corrupted. The summary reports those counters alongside faults,
+// coverage and throughput.
+//
+// Usage: Chip8_Fuzz [cases] [seed]
+//   cases  number of fuzz cases to run     (default: 1000000)
+//   seed   PRNG seed; same seed, same run  (default: 1)
+
+#include "chip8.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FUZZ_MAX_PROGRAM 256    // bytes per fuzzed program; small programs mutate better
+#define FUZZ_MAX_CORPUS 256     // corpus entries kept (new coverage stops being added beyond this)
+#define FUZZ_STEPS_PER_CASE 512 // instruction budget per case
+
+// One corpus entry: a program that reached at least one coverage bit first
+typedef struct {
+    uint8_t program[FUZZ_MAX_PROGRAM];
+    uint16_t len;
+} fuzz_entry;
+
+// Everything counted across the run
+typedef struct {
+    uint64_t cases;
+    uint64_t steps;
+    uint64_t bad_opcode;    // cases ended by CHIP8_ERR_BAD_OPCODE
+    uint64_t pc_oob;        // cases ended by CHIP8_ERR_PC_OOB
+    uint64_t sp_overflow;   // CALL attempted with all 16 stack slots in use
+    uint64_t sp_underflow;  // RET attempted with an empty stack
+    uint64_t i_overflow;    // memory opcode attempted with I reaching past the 4K space
+    uint64_t coverage;      // union of all coverage masks so far
+    uint32_t corpus_count;
+} fuzz_stats;
+
+// Fuzzer-local xorshift32 (same generator the core uses for Cxkk), so runs reproduce from
+// the seed alone
+static uint32_t fuzz_rng;
+static uint32_t fuzz_rand(void) {
+    uint32_t x = fuzz_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    fuzz_rng = x;
+    return x;
+}
+
+// Maps an opcode to its coverage bit (0..63), one bit per implemented instruction, mirroring
+// the dispatch table layout. Unimplemented encodings share bit 63, so a bad-opcode case still
+// contributes exactly one (uninteresting) bit.
+static int fuzz_opcode_bit(uint16_t opcode) {
+    uint8_t kk = (uint8_t)(opcode & 0x00FF);
+    switch (opcode >> 12) {
+    case 0x0:
+        if (opcode == 0x00E0) return 0;
+        if (opcode == 0x00EE) return 1;
+        break;
+    case 0x1: return 2;
+    case 0x2: return 3;
+    case 0x3: return 4;
+    case 0x4: return 5;
+    case 0x5: if ((opcode & 0x000F) == 0) return 6; break;
+    case 0x6: return 7;
+    case 0x7: return 8;
+    case 0x8: {
+        uint8_t n = (uint8_t)(opcode & 0x000F);
+        if (n <= 0x7) return 9 + n;     // bits 9..16: 8xy0..8xy7
+        if (n == 0xE) return 17;
+        break;
+    }
+    case 0x9: if ((opcode & 0x000F) == 0) return 18; break;
+    case 0xA: return 19;
+    case 0xB: return 20;
+    case 0xC: return 21;
+    case 0xD: return 22;
+    case 0xE:
+        if (kk == 0x9E) return 23;
+        if (kk == 0xA1) return 24;
+        break;
+    case 0xF:
+        switch (kk) {
+        case 0x07: return 25;
+        case 0x0A: return 26;
+        case 0x15: return 27;
+        case 0x18: return 28;
+        case 0x1E: return 29;
+        case 0x1F: return 30;
+        case 0x29: return 31;
+        case 0x33: return 32;
+        case 0x55: return 33;
+        case 0x65: return 34;
+        default: break;
+        }
+        break;
+    default:
+        break;
+    }
+    return 63;
+}
+
+// How many bytes past I the given opcode touches, or 0 if it does not use I as a memory
+// pointer. Used to catch I overflowing the 4K space before the handler writes outside `mem`.
+static uint16_t fuzz_opcode_mem_span(uint16_t opcode) {
+    uint8_t x = (uint8_t)((opcode & 0x0F00) >> 8);
+    switch (opcode >> 12) {
+    case 0xD: return (uint16_t)(opcode & 0x000F);   // DRW reads n sprite rows
+    case 0xF:
+        switch (opcode & 0x00FF) {
+        case 0x33: return 3;                        // BCD writes I..I+2
+        case 0x55: case 0x65: return (uint16_t)(x + 1);
+        default: return 0;
+        }
+    default: return 0;
+    }
+}
+
+// Runs one program for the step budget, accumulating stats and returning its coverage mask
+static uint64_t fuzz_run_case(chip8_t* chip, const chip8_t* golden,
+    const uint8_t* program, uint16_t len, fuzz_stats* stats) {
+    // O(dirty state) case reset: copy back only what the previous case wrote (keeps the
+    // dcache attached and flushes it), then drop the program into memory
+    chip8_reset_from(chip, golden);
+    chip8_load_rom_from_memory(chip, program, len);
+    chip8_seed(chip, fuzz_rand());
+
+    uint64_t coverage = 0;
+
+    for (uint32_t step = 0; step < FUZZ_STEPS_PER_CASE; step++) {
+        if (chip->waiting_key) {
+            // Parked on Fx0A: feed it a key, like a twitchy player would
+            chip8_set_key(chip, (chip8_key)(fuzz_rand() & 0xF), 1);
+            continue;
+        }
+        if (chip->idle) {
+            // Parked in a spin loop: a timer tick re-arms it; if it parks again immediately
+            // the case is effectively over
+            chip8_tick_timers(chip);
+            if (chip->idle) {
+                break;
+            }
+        }
+        if (chip->pc >= CHIP8_MEM_SIZE - 1) {
+            stats->pc_oob++;
+            break;
+        }
+
+        uint16_t opcode = (chip->mem[chip->pc] << 8) | chip->mem[chip->pc + 1];
+        coverage |= 1ull << fuzz_opcode_bit(opcode);
+
+        // Probe the hazard edges this fuzzer exists to exercise, ending the case instead of
+        // letting the handler corrupt memory beyond the emulated machine
+        if ((opcode & 0xF000) == 0x2000 && chip->sp >= CHIP8_STACK_SIZE) {
+            stats->sp_overflow++;
+            break;
+        }
+        // Family 0 dispatches on the low byte alone, so every 0x0xEE encoding reaches RET
+        if ((opcode >> 12) == 0x0 && (opcode & 0x00FF) == 0xEE && chip->sp == 0) {
+            stats->sp_underflow++;
+            break;
+        }
+        uint16_t span = fuzz_opcode_mem_span(opcode);
+        if (span != 0 && (uint32_t)chip->I + span > CHIP8_MEM_SIZE) {
+            stats->i_overflow++;
+            break;
+        }
+
+        chip8_status status = chip8_step(chip);
+        stats->steps++;
+        if (status != CHIP8_OK) {
+            if (status == CHIP8_ERR_BAD_OPCODE) {
+                stats->bad_opcode++;
+            }
+            else {
+                stats->pc_oob++;
+            }
+            break;
+        }
+
+        // Release keys now and then so Ex9E/ExA1/Fx0A see both states across a case
+        if ((step & 0x3F) == 0x3F) {
+            chip8_set_key(chip, (chip8_key)(fuzz_rand() & 0xF), 0);
+            chip8_tick_timers(chip);
+        }
+    }
+
+    stats->cases++;
+    return coverage;
+}
+
+// Fills `program` with `len` random bytes
+static void fuzz_generate(uint8_t* program, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        program[i] = (uint8_t)fuzz_rand();
+    }
+}
+
+// Mutates `entry` into `program`/`len`: a few byte flips, sometimes a splice with random
+// bytes or a length change. Kept dumb on purpose - the coverage feedback does the steering.
+static uint16_t fuzz_mutate(const fuzz_entry* entry, uint8_t* program) {
+    uint16_t len = entry->len;
+    memcpy(program, entry->program, len);
+
+    uint32_t mutations = 1 + (fuzz_rand() & 0x7);
+    for (uint32_t m = 0; m < mutations; m++) {
+        switch (fuzz_rand() & 0x3) {
+        case 0: // flip one byte
+            program[fuzz_rand() % len] = (uint8_t)fuzz_rand();
+            break;
+        case 1: // flip one bit
+            program[fuzz_rand() % len] ^= (uint8_t)(1u << (fuzz_rand() & 7));
+            break;
+        case 2: // overwrite a short run with random bytes
+        {
+            uint16_t at = (uint16_t)(fuzz_rand() % len);
+            uint16_t run = (uint16_t)(1 + (fuzz_rand() & 0x7));
+            for (uint16_t i = 0; i < run && at + i < len; i++) {
+                program[at + i] = (uint8_t)fuzz_rand();
+            }
+            break;
+        }
+        default: // grow or shrink (within bounds), padding with random bytes
+            if ((fuzz_rand() & 1) && len < FUZZ_MAX_PROGRAM - 2) {
+                program[len++] = (uint8_t)fuzz_rand();
+                program[len++] = (uint8_t)fuzz_rand();
+            }
+            else if (len > 4) {
+                len -= 2;
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+int main(int argc, char** argv) {
+    uint64_t cases = (argc > 1) ? (uint64_t)strtoull(argv[1], NULL, 10) : 1000000ull;
+    fuzz_rng = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 1u;
+    if (fuzz_rng == 0) {
+        fuzz_rng = 1;
+    }
+
+    // One working instance plus one pristine golden instance; every case resets from the
+    // golden copy
+    chip8_t* chip = (chip8_t*)malloc(sizeof(chip8_t));
+    chip8_t* golden = (chip8_t*)malloc(sizeof(chip8_t));
+    fuzz_entry* corpus = (fuzz_entry*)malloc((size_t)FUZZ_MAX_CORPUS * sizeof(fuzz_entry));
+    if (chip == NULL || golden == NULL || corpus == NULL) {
+        return 1;
+    }
+    memset(chip, 0, sizeof(chip8_t));
+    memset(golden, 0, sizeof(chip8_t));
+    chip8_init(chip);
+    chip8_init(golden);
+    chip8_dcache_enable(chip, true);
+
+    fuzz_stats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    // Seed the corpus with one random program
+    corpus[0].len = 64;
+    fuzz_generate(corpus[0].program, corpus[0].len);
+    stats.corpus_count = 1;
+
+    uint8_t program[FUZZ_MAX_PROGRAM];
+    clock_t start = clock();
+
+    for (uint64_t n = 0; n < cases; n++) {
+        const fuzz_entry* parent = &corpus[fuzz_rand() % stats.corpus_count];
+        uint16_t len = fuzz_mutate(parent, program);
+
+        uint64_t coverage = fuzz_run_case(chip, golden, program, len, &stats);
+
+        // New coverage: keep the program so later cases mutate it further
+        if ((coverage & ~stats.coverage) != 0 && stats.corpus_count < FUZZ_MAX_CORPUS) {
+            fuzz_entry* entry = &corpus[stats.corpus_count++];
+            memcpy(entry->program, program, len);
+            entry->len = len;
+        }
+        stats.coverage |= coverage;
+    }
+
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    int bits = 0;
+    for (int i = 0; i < 63; i++) {  // bit 63 (unimplemented encodings) is not coverage
+        if (stats.coverage & (1ull << i)) {
+            bits++;
+        }
+    }
+
+    printf("cases:        %llu\n", (unsigned long long)stats.cases);
+    printf("steps:        %llu\n", (unsigned long long)stats.steps);
+    printf("elapsed:      %.2f s (%.0f cases/s)\n", elapsed,
+        elapsed > 0.0 ? (double)stats.cases / elapsed : 0.0);
+    printf("coverage:     %d/35 opcodes, corpus %u\n", bits, stats.corpus_count);
+    printf("bad_opcode:   %llu\n", (unsigned long long)stats.bad_opcode);
+    printf("pc_oob:       %llu\n", (unsigned long long)stats.pc_oob);
+    printf("sp_overflow:  %llu\n", (unsigned long long)stats.sp_overflow);
+    printf("sp_underflow: %llu\n", (unsigned long long)stats.sp_underflow);
+    printf("i_overflow:   %llu\n", (unsigned long long)stats.i_overflow);
+
+    chip8_dcache_enable(chip, false);
+    free(corpus);
+    free(golden);
+    free(chip);
+    return 0;
+}
@@ -1,6 +1,9 @@
 #include <GL/freeglut.h>
 #include <stdio.h>
 #include "chip8.h"
+#include "chip8_audio.h"
+#include "chip8_rewind.h"
+#include "chip8_shm.h"
 #include <stdbool.h>
 
 // Constants for window size and scaling
@@ -8,10 +11,53 @@
 #define SCREEN_HEIGHT CHIP8_DISPLAY_HEIGHT*10
 #define PIXEL_SIZE 10
 
+// When set, the Chip-8 screen is uploaded as a single 64x32 RGB texture and drawn as one
+// screen-filling quad with nearest filtering, instead of one glBegin/glEnd quad per pixel
+// (2048 of them per frame). Set to 0 to fall back to the immediate-mode per-pixel renderer.
+#define USE_TEXTURE_RENDERER 1
+
+// How many instructions the emulated CPU executes per real second. Decoupled from the render
+// rate: a slow GL swap no longer slows the game down and a fast one no longer overclocks it.
+// The default matches the speed the old per-frame loop aimed for (CHIP8_CYCLES_PER_FRAME
+// instructions at 60 frames per second).
+#define CHIP8_CPU_HZ (CHIP8_CYCLES_PER_FRAME * 60)
+
+// How many instructions to run per scheduler tick while fast-forward is active (toggled with
+// the Tab key): emulation runs as fast as the CPU allows instead of tracking real time.
+#define FAST_FORWARD_CYCLES_PER_TICK (CHIP8_CPU_HZ / 10)
+
+// When set, every frame is also published into the "chip8_display" shared-memory segment so
+// out-of-process viewers (dashboards etc.) can poll the screen with zero copies in between
+// (see chip8_shm.h). Off by default; the publish itself never blocks the emulation thread.
+#define USE_SHM_EXPORT 0
+
 // Global Chip-8 emulator instance
 chip8_t chip;
 
-void timer(int value); // Declare the timer function prototype
+// The renderer's private copy of the last presented frame. display() fills it with
+// chip8_display_read and draws only from it, so rendering never touches the interpreter's
+// working display buffers - ready for running emulation and rendering on separate threads.
+uint8_t frame_buffer[CHIP8_DISPLAY_BUFFER_SIZE];
+
+// Fixed-timestep scheduler state
+int last_tick_ms = 0;            // glutGet(GLUT_ELAPSED_TIME) at the previous scheduler tick
+double pending_cycles = 0.0;     // fractional instructions owed to the emulated CPU
+double pending_timer_ticks = 0.0; // fractional 60 Hz delay/sound timer ticks owed
+bool fast_forward = false;       // when set, ignore real time and run flat out
+bool fault_reported = false;     // a latched emulation fault has already been printed
+
+chip8_audio_t* audio = NULL;     // beep output; NULL (no sound) if the device failed to open
+
+// Rewind ring: a checkpoint every REWIND_CHECKPOINT_TICKS timer ticks (half a second of
+// emulated time), Backspace steps back one checkpoint per press. 256 slots is about two
+// minutes of history in under 2 MB of memory-mapped file.
+#define REWIND_CHECKPOINT_TICKS 30
+chip8_rewind_t* rewind_ring = NULL; // NULL (no rewind) if the ring file failed to map
+int rewind_tick_count = 0;       // timer ticks since the last checkpoint
+
+#if USE_SHM_EXPORT
+chip8_shm_t* shm = NULL;         // shared-memory display export; NULL if creation failed
+#endif
 
 // Define 16 colors as an array of RGB values
 float colors[][3] = {
@@ -33,20 +79,97 @@ float colors[][3] = {
     {0.2f, 0.8f, 0.8f}
 };
 
+#if USE_TEXTURE_RENDERER
+// Texture object holding the 64x32 Chip-8 screen
+GLuint screen_texture;
+
+// Creates the screen texture with nearest filtering, so the 64x32 image scales up to the
+// window as crisp square pixels and all the PIXEL_SIZE quad math collapses into one quad.
+void init_screen_texture() {
+    glGenTextures(1, &screen_texture);
+    glBindTexture(GL_TEXTURE_2D, screen_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, CHIP8_DISPLAY_WIDTH, CHIP8_DISPLAY_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+}
+
+// Converts the given display rows into RGB texels and uploads them into the screen texture,
+// one glTexSubImage2D call per dirty row.
+void upload_screen_rows(uint32_t rows) {
+    uint8_t texels[CHIP8_DISPLAY_WIDTH * 3];
+
+    glBindTexture(GL_TEXTURE_2D, screen_texture);
+    for (int y = 0; y < CHIP8_DISPLAY_HEIGHT; y++) {
+        if (!(rows & (1u << y))) {
+            continue;
+        }
+        for (int x = 0; x < CHIP8_DISPLAY_WIDTH; x++) {
+            uint8_t color_index;
+            if (chip.colorMode) {
+                // In color mode each display byte packs two 4-bit pixels
+                uint8_t pixel = frame_buffer[y * CHIP8_DISPLAY_WIDTH + x / 2];
+                color_index = (x % 2 == 0) ? (pixel & 0xF0) >> 4 : pixel & 0x0F;
+            }
+            else {
+                color_index = frame_buffer[y * CHIP8_DISPLAY_WIDTH + x] ? 1 : 0;
+            }
+            texels[x * 3 + 0] = (uint8_t)(colors[color_index][0] * 255.0f);
+            texels[x * 3 + 1] = (uint8_t)(colors[color_index][1] * 255.0f);
+            texels[x * 3 + 2] = (uint8_t)(colors[color_index][2] * 255.0f);
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, CHIP8_DISPLAY_WIDTH, 1, GL_RGB, GL_UNSIGNED_BYTE, texels);
+    }
+}
+#endif
+
 // Display function for OpenGL window
 void display() {
-    glClear(GL_COLOR_BUFFER_BIT);
+    // Dirty rows from the frame before last; with double buffering the back buffer we draw into
+    // still shows that frame, so its dirty rows have to be redrawn along with this frame's.
+    static uint32_t prev_dirty_rows = 0xFFFFFFFF;
 
-    // Run the emulator for one frame
-    for (int i = 0; i < CHIP8_CYCLES_PER_FRAME; i++) {
-        chip8_step(&chip);
+    // Only redraw rows the emulator actually touched; skip the frame entirely when idle
+    uint32_t dirty_rows = chip8_take_dirty_rows(&chip);
+    uint32_t redraw_rows = dirty_rows | prev_dirty_rows;
+    prev_dirty_rows = dirty_rows;
+
+    if (redraw_rows == 0) {
+        return; // Nothing changed since the last frame
+    }
+
+    // Grab the last presented frame; drawing below reads only this copy, never the
+    // interpreter's working buffers (no frame presented yet means nothing to draw)
+    if (!chip8_display_read(&chip, frame_buffer, NULL)) {
+        return;
     }
 
+#if USE_TEXTURE_RENDERER
+    // The texture persists between frames, so only this frame's dirty rows need uploading;
+    // the quad below repaints the whole back buffer from it either way.
+    upload_screen_rows(dirty_rows);
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, screen_texture);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, (float)SCREEN_HEIGHT);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f((float)SCREEN_WIDTH, (float)SCREEN_HEIGHT);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f((float)SCREEN_WIDTH, 0.0f);
+    glEnd();
+    glDisable(GL_TEXTURE_2D);
+#else
+    // No glClear: every redrawn row paints all of its pixels (off pixels as black quads), and
+    // rows that are not redrawn intentionally keep their previous contents in the back buffer.
+
     if (chip.colorMode) {
         // Draw pixels from Chip-8 screen buffer
         for (int y = 0; y < CHIP8_DISPLAY_HEIGHT; y++) {
+            if (!(redraw_rows & (1u << y))) {
+                continue;
+            }
             for (int x = 0; x < CHIP8_DISPLAY_WIDTH / 2; x++) {
-                uint8_t pixel = chip.display[y * CHIP8_DISPLAY_WIDTH + x];
+                uint8_t pixel = frame_buffer[y * CHIP8_DISPLAY_WIDTH + x];
                 uint8_t left_color_index = (pixel & 0xF0) >> 4;
                 uint8_t right_color_index = pixel & 0x0F;
 
@@ -71,10 +194,13 @@ void display() {
         }
     }
     else {
-        // Draw pixels from Chip-8 screen buffer
+        // Draw pixels from the presented frame (already expanded to byte-per-pixel)
         for (int y = 0; y < CHIP8_DISPLAY_HEIGHT; y++) {
+            if (!(redraw_rows & (1u << y))) {
+                continue;
+            }
             for (int x = 0; x < CHIP8_DISPLAY_WIDTH; x++) {
-                uint8_t pixel = chip.display[y * CHIP8_DISPLAY_WIDTH + x];
+                uint8_t pixel = frame_buffer[y * CHIP8_DISPLAY_WIDTH + x];
                 if (pixel) {
                     glColor3f(1.0f, 1.0f, 1.0f);
                 }
@@ -90,21 +216,109 @@ void display() {
             }
         }
     }
+#endif
 
     glutSwapBuffers();
-    timer(0); // Call the timer function again to keep updating
 }
 
-// Timer function to update the screen
-void timer(int value) {
-    glutPostRedisplay(); // Schedule a call to the display function
-    glutTimerFunc(1000 / 60, timer, 0); // Call this function again after 1000/60 milliseconds (approx. 60 FPS)
+// Fixed-timestep scheduler: accumulates real elapsed time, owes the emulated CPU
+// CHIP8_CPU_HZ instructions per second of it, and runs whatever whole number of instructions
+// is due - so emulation speed tracks the wall clock no matter how fast or slow rendering is.
+// Rendering is requested separately via glutPostRedisplay and runs at whatever rate the
+// display can sustain (display() skips all GL work when nothing changed).
+void tick(int value) {
+    // Re-arm first so scheduling jitter in this tick doesn't accumulate
+    glutTimerFunc(1, tick, 0);
+
+    int now_ms = glutGet(GLUT_ELAPSED_TIME);
+    int elapsed_ms = now_ms - last_tick_ms;
+    last_tick_ms = now_ms;
+
+    // Clamp huge gaps (window dragging, breakpoints) so the emulator doesn't try to catch up
+    // on seconds of missed time in one burst
+    if (elapsed_ms > 250) {
+        elapsed_ms = 250;
+    }
+
+    uint32_t cycles;
+    if (fast_forward) {
+        // Ignore real time: run a fixed large batch per tick, bounded only by host CPU speed,
+        // and scale the 60 Hz timers with the executed instructions so games speed up uniformly
+        cycles = FAST_FORWARD_CYCLES_PER_TICK;
+        pending_cycles = 0.0;
+        pending_timer_ticks += (double)cycles * 60.0 / CHIP8_CPU_HZ;
+    }
+    else {
+        pending_cycles += (double)elapsed_ms * CHIP8_CPU_HZ / 1000.0;
+        cycles = (uint32_t)pending_cycles;
+        pending_cycles -= cycles;
+        // The delay/sound timers track real time at 60 Hz, independent of the CPU rate
+        pending_timer_ticks += (double)elapsed_ms * 60.0 / 1000.0;
+    }
+
+    if (cycles > 0) {
+        // The core latches the first fault and halts instead of printing, so report it here
+        // once (with the recent execution history) and leave the last frame on screen
+        chip8_status status = chip8_run(&chip, cycles);
+        if (status != CHIP8_OK && !fault_reported) {
+            fault_reported = true;
+            fprintf(stderr, "Emulation fault (%s) at pc=0x%04X opcode=0x%04X\n",
+                (status == CHIP8_ERR_BAD_OPCODE) ? "bad opcode" : "pc out of bounds",
+                chip.fault_pc, chip.fault_opcode);
+            chip8_trace_dump(&chip, stderr);
+        }
+
+        // The batch is done, so the display is at a frame boundary: publish it for the
+        // renderer (a seqlock-guarded copy, no locking on either side)
+        chip8_present(&chip);
+    }
+
+    while (pending_timer_ticks >= 1.0) {
+        chip8_tick_timers(&chip);
+        pending_timer_ticks -= 1.0;
+
+        // Periodic checkpoint into the memory-mapped rewind ring (one snapshot memcpy)
+        if (rewind_ring != NULL && ++rewind_tick_count >= REWIND_CHECKPOINT_TICKS) {
+            rewind_tick_count = 0;
+            chip8_rewind_checkpoint(rewind_ring, &chip);
+        }
+    }
+
+    // Forward the beep flag to the audio thread (edge-detected and lock-free inside)
+    chip8_audio_update(audio, chip.sound_playing != 0);
+
+#if USE_SHM_EXPORT
+    if (shm != NULL) {
+        chip8_shm_publish(shm, &chip);
+    }
+#endif
+
+    glutPostRedisplay();
 }
 
 // Key press callback function
 void key_down(unsigned char key, int x, int y) {
     chip8_key chip_key;
 
+    // Tab toggles fast-forward (emulation runs flat out instead of tracking real time)
+    if (key == '\t') {
+        fast_forward = !fast_forward;
+        return;
+    }
+
+    // Backspace rewinds one checkpoint (~half a second); holding it walks further back.
+    // The first press after startup may only have the newest checkpoint to fall back on.
+    if (key == 8) {
+        if (rewind_ring != NULL) {
+            if (!chip8_rewind_restore(rewind_ring, &chip, 1)) {
+                chip8_rewind_restore(rewind_ring, &chip, 0);
+            }
+            // The restored state predates any latched fault, so let a recurrence be reported
+            fault_reported = false;
+        }
+        return;
+    }
+
     switch (key) {
     case 'x': chip_key = CHIP8_KEY_0; break;
     case '1': chip_key = CHIP8_KEY_1; break;
@@ -179,6 +393,23 @@ int main(int argc, char** argv) {
     //bool success = chip8_load_program_from_hex_string(&chip, test_program);
 
     if (success) {
+        // Decode each program address once instead of per execution
+        chip8_dcache_enable(&chip, true);
+
+        // Publish the initial (blank) display so the first rendered frame has something to read
+        chip8_present(&chip);
+
+        // Start the audio thread for the sound timer's beep. A NULL result just means no sound.
+        audio = chip8_audio_init();
+
+        // Continuous checkpointing for Backspace-rewind. A NULL result just means no rewind.
+        rewind_ring = chip8_rewind_create("chip8_rewind.ring", 256);
+
+#if USE_SHM_EXPORT
+        // Export the display for out-of-process viewers. A NULL result just means no export.
+        shm = chip8_shm_create("chip8_display");
+#endif
+
         // Initialize freeglut and create window
         glutInit(&argc, argv);
         glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE);
@@ -202,17 +433,29 @@ int main(int argc, char** argv) {
 
         // Set the color for drawing pixels
         glColor3f(1.0f, 1.0f, 1.0f);
-        
+
+#if USE_TEXTURE_RENDERER
+        // Create the texture the Chip-8 screen is uploaded into
+        init_screen_texture();
+#endif
+
 
         // Register display function and keyboard input functions
         glutDisplayFunc(display);
         glutKeyboardFunc(key_down);
         glutKeyboardUpFunc(key_up);
-        // Register the timer function to update the screen continuously
-        glutTimerFunc(1000 / 60, timer, 0);
+        // Start the fixed-timestep scheduler that drives emulation and requests redraws
+        last_tick_ms = glutGet(GLUT_ELAPSED_TIME);
+        glutTimerFunc(1, tick, 0);
 
         // Enter main loop
         glutMainLoop();
+
+#if USE_SHM_EXPORT
+        chip8_shm_close(shm);
+#endif
+        chip8_rewind_close(rewind_ring);
+        chip8_audio_shutdown(audio);
     }
 
     getchar();
@@ -0,0 +1,321 @@
+// Batch ROM validation driver.
+//
+// Scans a directory for .ch8 files and runs every ROM headless for a fixed frame budget on a
+// pool of worker threads (one chip8_t per worker, reused across ROMs), watching for the two
+// failure modes a broken ROM exhibits: an opcode the interpreter does not implement, and a
+// program counter that leaves memory. Both are reported by chip8_run as a chip8_status with
+// the faulting PC/opcode latched in the instance. One machine-readable line is printed per
+// ROM:
+//
+//   PASS <file> cycles=<executed>
+//   FAIL <file> reason=<bad_opcode|pc_oob> pc=0x<PC> opcode=0x<OP> cycles=<executed>
+//
+// plus a trailing "summary: ..." line; the exit code is the number of failing ROMs (0 = all
+// passed). This replaces the old shell loop around the GUI build, which validated one ROM per
+// process launch.
+//
+// Usage: Chip8_Validate [directory] [frames] [threads]
+//   directory  folder scanned (non-recursively) for .ch8 files  (default: ../Games)
+//   frames     emulated frames to run per ROM, 60 per second    (default: 600)
+//   threads    worker threads; 0 = one per processor core       (default: 0)
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "chip8.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Thin portability layer over Win32 threads / pthreads, same shape as in chip8_pool.c. The
+// validator only needs threads and one mutex (for handing out work and serializing output).
+#if defined(_WIN32)
+
+#include <windows.h>
+
+typedef HANDLE chip8_thread;
+typedef CRITICAL_SECTION chip8_mutex;
+
+#define chip8_mutex_init(m)    InitializeCriticalSection(m)
+#define chip8_mutex_destroy(m) DeleteCriticalSection(m)
+#define chip8_mutex_lock(m)    EnterCriticalSection(m)
+#define chip8_mutex_unlock(m)  LeaveCriticalSection(m)
+
+static uint32_t validate_core_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (uint32_t)info.dwNumberOfProcessors;
+}
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+
+typedef pthread_t chip8_thread;
+typedef pthread_mutex_t chip8_mutex;
+
+#define chip8_mutex_init(m)    pthread_mutex_init(m, NULL)
+#define chip8_mutex_destroy(m) pthread_mutex_destroy(m)
+#define chip8_mutex_lock(m)    pthread_mutex_lock(m)
+#define chip8_mutex_unlock(m)  pthread_mutex_unlock(m)
+
+static uint32_t validate_core_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (uint32_t)n : 1;
+}
+
+#endif
+
+#define VALIDATE_MAX_ROMS 4096
+#define VALIDATE_MAX_PATH 512
+
+// Outcome of one ROM run
+typedef enum {
+    VALIDATE_PASS = 0,
+    VALIDATE_FAIL_BAD_OPCODE,
+    VALIDATE_FAIL_PC_OOB
+} validate_result;
+
+// Work list and shared counters
+typedef struct {
+    char (*paths)[VALIDATE_MAX_PATH];
+    uint32_t rom_count;
+    uint32_t frames;
+
+    chip8_mutex lock;
+    uint32_t next;          // next unclaimed ROM index
+    uint32_t failed;        // total FAIL lines printed
+} validate_state;
+
+// Reads a ROM file into `buf`, returning its length or 0 on failure. The workers read files
+// themselves (instead of chip8_load_rom) because the global ROM cache behind chip8_load_rom
+// is not thread-safe, and every ROM here is read exactly once anyway.
+static size_t validate_read_rom(const char* path, uint8_t* buf, size_t buf_size) {
+    FILE* file;
+#if defined(_MSC_VER) || defined(__STDC_LIB_EXT1__)
+    if (fopen_s(&file, path, "rb") != 0) {
+        file = NULL;
+    }
+#else
+    file = fopen(path, "rb");
+#endif
+    if (file == NULL) {
+        return 0;
+    }
+    size_t len = fread(buf, 1, buf_size, file);
+    if (len == buf_size && fgetc(file) != EOF) {
+        // Larger than Chip-8 program memory: treat as unreadable
+        len = 0;
+    }
+    fclose(file);
+    return len;
+}
+
+// Runs one ROM for the frame budget and classifies the outcome from the chip8_run status (the
+// faulting PC and opcode come latched in the instance); a ROM that parks idle or in key-wait
+// early simply passes with fewer executed cycles.
+static validate_result validate_rom(chip8_t* chip, const char* path, uint32_t frames,
+    uint16_t* fault_pc, uint16_t* fault_opcode, uint64_t* executed) {
+    // Fresh machine per ROM; recreate the predecode cache rather than leaking the old one
+    chip8_dcache_enable(chip, false);
+    chip8_init(chip);
+    chip8_dcache_enable(chip, true);
+
+    *fault_pc = 0;
+    *fault_opcode = 0;
+    *executed = 0;
+
+    uint8_t rom[CHIP8_MEM_SIZE - CHIP8_PROGRAM_OFFSET];
+    size_t len = validate_read_rom(path, rom, sizeof(rom));
+    if (len == 0 || !chip8_load_rom_from_memory(chip, rom, len)) {
+        // Unreadable/oversized ROMs surface as an out-of-bounds class failure
+        return VALIDATE_FAIL_PC_OOB;
+    }
+
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        chip8_status status = chip8_run(chip, CHIP8_CYCLES_PER_FRAME);
+        if (status != CHIP8_OK) {
+            *fault_pc = chip->fault_pc;
+            *fault_opcode = chip->fault_opcode;
+            *executed = chip->cycles;
+            return (status == CHIP8_ERR_BAD_OPCODE)
+                ? VALIDATE_FAIL_BAD_OPCODE : VALIDATE_FAIL_PC_OOB;
+        }
+        chip8_tick_timers(chip);
+    }
+
+    *executed = chip->cycles;
+    return VALIDATE_PASS;
+}
+
+// Worker main loop: claim the next unvalidated ROM, run it, print its report line
+static void validate_work(validate_state* state) {
+    chip8_t* chip = (chip8_t*)malloc(sizeof(chip8_t));
+    if (chip == NULL) {
+        return;
+    }
+    memset(chip, 0, sizeof(chip8_t));
+
+    for (;;) {
+        chip8_mutex_lock(&state->lock);
+        uint32_t index = state->next;
+        if (index < state->rom_count) {
+            state->next++;
+        }
+        chip8_mutex_unlock(&state->lock);
+        if (index >= state->rom_count) {
+            break;
+        }
+
+        uint16_t fault_pc, fault_opcode;
+        uint64_t executed;
+        validate_result result = validate_rom(chip, state->paths[index], state->frames,
+            &fault_pc, &fault_opcode, &executed);
+
+        chip8_mutex_lock(&state->lock);
+        switch (result) {
+        case VALIDATE_PASS:
+            printf("PASS %s cycles=%llu\n", state->paths[index], (unsigned long long)executed);
+            break;
+        case VALIDATE_FAIL_BAD_OPCODE:
+            printf("FAIL %s reason=bad_opcode pc=0x%04X opcode=0x%04X cycles=%llu\n",
+                state->paths[index], fault_pc, fault_opcode, (unsigned long long)executed);
+            state->failed++;
+            break;
+        case VALIDATE_FAIL_PC_OOB:
+            printf("FAIL %s reason=pc_oob pc=0x%04X cycles=%llu\n",
+                state->paths[index], fault_pc, (unsigned long long)executed);
+            state->failed++;
+            break;
+        }
+        chip8_mutex_unlock(&state->lock);
+    }
+
+    chip8_dcache_enable(chip, false);
+    free(chip);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI validate_thread_main(LPVOID arg) {
+    validate_work((validate_state*)arg);
+    return 0;
+}
+#else
+static void* validate_thread_main(void* arg) {
+    validate_work((validate_state*)arg);
+    return NULL;
+}
+#endif
+
+// Returns true if `name` ends in ".ch8" (case-insensitive)
+static bool validate_is_rom(const char* name) {
+    size_t len = strlen(name);
+    if (len < 4) {
+        return false;
+    }
+    const char* ext = name + len - 4;
+    return (ext[0] == '.')
+        && (ext[1] == 'c' || ext[1] == 'C')
+        && (ext[2] == 'h' || ext[2] == 'H')
+        && ext[3] == '8';
+}
+
+// Fills `paths` with every .ch8 file in `directory` (non-recursive); returns the count
+static uint32_t validate_scan(const char* directory, char (*paths)[VALIDATE_MAX_PATH]) {
+    uint32_t count = 0;
+
+#if defined(_WIN32)
+    char pattern[VALIDATE_MAX_PATH];
+    _snprintf_s(pattern, sizeof(pattern), _TRUNCATE, "%s\\*", directory);
+
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    do {
+        if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && validate_is_rom(entry.cFileName)
+            && count < VALIDATE_MAX_ROMS) {
+            _snprintf_s(paths[count], VALIDATE_MAX_PATH, _TRUNCATE, "%s\\%s", directory, entry.cFileName);
+            count++;
+        }
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory);
+    if (dir == NULL) {
+        return 0;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (validate_is_rom(entry->d_name) && count < VALIDATE_MAX_ROMS) {
+            snprintf(paths[count], VALIDATE_MAX_PATH, "%s/%s", directory, entry->d_name);
+            count++;
+        }
+    }
+    closedir(dir);
+#endif
+
+    return count;
+}
+
+int main(int argc, char** argv) {
+    const char* directory = (argc > 1) ? argv[1] : "../Games";
+    uint32_t frames = (argc > 2) ? (uint32_t)atoi(argv[2]) : 600;
+    uint32_t thread_count = (argc > 3) ? (uint32_t)atoi(argv[3]) : 0;
+
+    if (thread_count == 0) {
+        thread_count = validate_core_count();
+    }
+
+    validate_state state;
+    memset(&state, 0, sizeof(state));
+    state.paths = (char (*)[VALIDATE_MAX_PATH])malloc((size_t)VALIDATE_MAX_ROMS * VALIDATE_MAX_PATH);
+    if (state.paths == NULL) {
+        return 1;
+    }
+    state.frames = frames;
+    state.rom_count = validate_scan(directory, state.paths);
+    if (state.rom_count == 0) {
+        fprintf(stderr, "no .ch8 files found in %s\n", directory);
+        free(state.paths);
+        return 1;
+    }
+    if (thread_count > state.rom_count) {
+        thread_count = state.rom_count;
+    }
+    chip8_mutex_init(&state.lock);
+
+    chip8_thread* threads = (chip8_thread*)malloc(thread_count * sizeof(chip8_thread));
+    if (threads == NULL) {
+        free(state.paths);
+        return 1;
+    }
+
+    for (uint32_t t = 0; t < thread_count; t++) {
+#if defined(_WIN32)
+        threads[t] = CreateThread(NULL, 0, validate_thread_main, &state, 0, NULL);
+#else
+        pthread_create(&threads[t], NULL, validate_thread_main, &state);
+#endif
+    }
+    for (uint32_t t = 0; t < thread_count; t++) {
+#if defined(_WIN32)
+        WaitForSingleObject(threads[t], INFINITE);
+        CloseHandle(threads[t]);
+#else
+        pthread_join(threads[t], NULL);
+#endif
+    }
+
+    printf("summary: roms=%u passed=%u failed=%u threads=%u frames=%u\n",
+        state.rom_count, state.rom_count - state.failed, state.failed, thread_count, frames);
+
+    chip8_mutex_destroy(&state.lock);
+    free(threads);
+    free(state.paths);
+    return (int)state.failed;
+}